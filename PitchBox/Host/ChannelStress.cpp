@@ -0,0 +1,137 @@
+#include "MockHal.h"
+#include "Core/SpscQueue.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+
+/*
+Stress test of the lock-free handoff between the control loop and the audio callback, with the producer and the
+consumer on separate threads. Every snapshot is derived from a sequence number, so the consumer can check it sees
+whole snapshots (no tearing) in order (no reordering or duplicates). Build with SANITIZE=thread to also have the
+accesses checked for data races.
+*/
+
+namespace {
+	struct Snapshot {
+		uint32_t sequence;
+		uint32_t values[7];
+	};
+
+	bool isConsistent(const Snapshot& snapshot){
+		for(uint32_t i = 0; i < 7; i++){
+			if(snapshot.values[i] != snapshot.sequence * 7 + i) return false;
+		}
+		return true;
+	}
+
+	/// The queue on its own, as fast as both sides can go
+	bool stressQueue(const uint32_t count){
+		static SpscQueue<Snapshot, 8> queue;
+		std::atomic<bool> isOk{true};
+
+		std::thread producer([&]{
+			for(uint32_t sequence = 1; sequence <= count;){
+				Snapshot snapshot{sequence, {}};
+				for(uint32_t i = 0; i < 7; i++) snapshot.values[i] = sequence * 7 + i;
+				if(queue.push(snapshot)) sequence++;
+				else std::this_thread::yield(); // the consumer may be on the same core
+			}
+		});
+
+		std::thread consumer([&]{
+			uint32_t expected = 1;
+			Snapshot snapshot;
+			while(expected <= count){
+				if(!queue.pop(snapshot)){
+					std::this_thread::yield();
+					continue;
+				}
+				if(snapshot.sequence != expected++ || !isConsistent(snapshot)) isOk = false;
+			}
+		});
+
+		producer.join();
+		consumer.join();
+
+		printf("queue:   %u snapshots %s\n", count, isOk ? "passed in order, none torn" : "FAILED");
+		return isOk;
+	}
+
+	/// Controls encoding a sequence number in every field
+	DspCore::Controls controlsOf(const uint32_t sequence){
+		DspCore::Controls controls;
+		controls.distancePitch = static_cast<float>(sequence % 100000);
+		controls.distanceVolume = controls.distancePitch + 1.f;
+		for(int knob = 0; knob < DspCore::NUM_KNOBS; knob++) controls.knobs[knob] = controls.distancePitch + 2.f + knob;
+		controls.buttons = static_cast<uint16_t>(sequence & 0x3ff);
+		controls.isLeftRight = (sequence & 0x400) != 0;
+		return controls;
+	}
+
+	bool isConsistent(const DspCore::Controls& controls, uint32_t& sequence){
+		sequence = static_cast<uint32_t>(controls.distancePitch);
+		const auto expected = controlsOf(sequence);
+
+		bool isSame = controls.distanceVolume == expected.distanceVolume
+			&& (controls.buttons & 0x3ff) == (sequence & 0x3ff) && controls.isLeftRight == expected.isLeftRight;
+		for(int knob = 0; knob < DspCore::NUM_KNOBS; knob++) isSame = isSame && controls.knobs[knob] == expected.knobs[knob];
+		return isSame;
+	}
+
+	/// The DSP core: the control thread publishes as fast as it can, the audio thread renders blocks
+	bool stressCore(const uint32_t blocks){
+		std::unique_ptr<DspCore> core(new DspCore());
+		core->init(48000.f);
+
+		std::atomic<bool> isDone{false};
+		std::atomic<bool> isOk{true};
+		uint32_t published = 0, applied = 0;
+
+		std::thread control([&]{
+			for(uint32_t sequence = 1; !isDone; sequence++){
+				if(core->setControls(controlsOf(sequence % 100000))) published++;
+				else std::this_thread::yield();
+			}
+		});
+
+		std::thread audio([&]{
+			float left[48], right[48];
+			float* out[2] = {left, right};
+			uint32_t previous = 0;
+
+			for(uint32_t block = 0; block < blocks; block++){
+				core->process(out, 48);
+
+				uint32_t sequence;
+				if(!isConsistent(core->getControls(), sequence)) isOk = false;
+				if(sequence != previous){
+					// snapshots may be skipped (superseded) but never go back, apart from the wrap of the encoding
+					if(sequence < previous && previous - sequence < 50000) isOk = false;
+					previous = sequence;
+					applied++;
+				}
+				std::this_thread::yield(); // let the control thread in between the callbacks
+			}
+			isDone = true;
+		});
+
+		control.join();
+		audio.join();
+
+		printf("core:    %u blocks, %u snapshots published, %u dropped, %u applied %s\n", blocks, published,
+			core->getDroppedControls(), applied, isOk ? "in order, none torn" : "FAILED");
+		return isOk;
+	}
+}
+
+int main(int argc, char** argv){
+	const uint32_t count = argc > 1 ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 0)) : 2000000;
+
+	const bool isQueueOk = stressQueue(count);
+	const bool isCoreOk = stressCore(count / 20);
+	return isQueueOk && isCoreOk ? 0 : 1;
+}
@@ -0,0 +1,214 @@
+#include "Ultrasonic/EchoCapture.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <unistd.h>
+
+/*
+Timelines of the echo state machine of the ultrasonic sensors, driven through start(), onEdge(), poll() and
+takeResult() the way the trigger, the pin interrupt and the main loop drive it:
+	echo      a normal echo, with the microsecond counter (GetUs) wrapping between the trigger and the echo
+	stale     edges which don't belong to the measurement: before the trigger, the end of an earlier pulse, after
+	          the window, after the measurement has finished
+	missing   no echo, and an echo which never ends, both finish with TIMEOUT once the window has passed
+	race      the falling edge and the timeout at the same time, in both orders
+Every measurement has to yield exactly one result. The race is then run for real, the edges from a second thread
+standing in for the interrupt while the main thread polls at the end of the window. Build with SANITIZE=thread (make
+check-race) to also have the accesses checked for data races. Exits with 1 if a check fails.
+*/
+
+namespace {
+	const uint32_t TIMEOUT_US = 30000;
+
+	/// Trigger 100 us before the counter wraps
+	const uint32_t NEAR_WRAP = 0xFFFFFFFFu - 99u;
+
+	int failures = 0;
+
+	void printUsage(const char* name){
+		fprintf(stderr,
+			"Usage: %s [-n measurements]\n"
+			"  -n  number of measurements of the threaded race, default 200000\n", name);
+	}
+
+	void check(const bool condition, const char* timeline, const char* what){
+		if(condition) return;
+		printf("%-8s FAILED: %s\n", timeline, what);
+		failures++;
+	}
+
+	/// Checks that exactly one result is there and it is the expected one
+	void checkResult(EchoCapture& capture, const char* timeline, const int32_t pulseUs, const uint32_t listenUs){
+		int32_t pulse = 0;
+		uint32_t listen = 0;
+		check(!capture.isBusy(), timeline, "the measurement is still running");
+		check(capture.takeResult(pulse, listen), timeline, "no result");
+		check(pulse == pulseUs, timeline, "wrong pulse length");
+		check(listen == listenUs, timeline, "wrong listening time");
+		check(!capture.takeResult(pulse, listen), timeline, "a second result");
+	}
+
+	void checkNoResult(EchoCapture& capture, const char* timeline){
+		int32_t pulse;
+		check(!capture.takeResult(pulse), timeline, "a result too early");
+	}
+
+	void testEcho(){
+		EchoCapture capture;
+		check(capture.start(NEAR_WRAP, TIMEOUT_US), "echo", "start refused");
+		check(!capture.start(NEAR_WRAP, TIMEOUT_US), "echo", "started twice");
+
+		capture.poll(NEAR_WRAP + 50);
+		capture.onEdge(true, NEAR_WRAP + 250); // past the wrap
+		check(capture.getState() == EchoCapture::State::WAIT_FALL, "echo", "rising edge missed");
+		capture.poll(NEAR_WRAP + 1000);
+		checkNoResult(capture, "echo");
+
+		capture.onEdge(false, NEAR_WRAP + 1750);
+		capture.poll(NEAR_WRAP + TIMEOUT_US + 10); // the main loop late, the result is there already
+		checkResult(capture, "echo", 1500, 1750);
+
+		// the next measurement starts from scratch
+		check(capture.start(NEAR_WRAP + 40000, TIMEOUT_US), "echo", "restart refused");
+		capture.onEdge(true, NEAR_WRAP + 40300);
+		capture.onEdge(false, NEAR_WRAP + 40800);
+		checkResult(capture, "echo", 500, 800);
+	}
+
+	void testStale(){
+		EchoCapture capture;
+		capture.start(NEAR_WRAP, TIMEOUT_US);
+
+		capture.onEdge(true, NEAR_WRAP - 20);	// before the trigger
+		capture.onEdge(false, NEAR_WRAP + 30);	// end of a pulse which started before the trigger
+		check(capture.getState() == EchoCapture::State::WAIT_RISE, "stale", "took an edge of an earlier pulse");
+		capture.onEdge(true, NEAR_WRAP + TIMEOUT_US + 1); // after the window
+		check(capture.getState() == EchoCapture::State::WAIT_RISE, "stale", "took an edge after the window");
+
+		capture.onEdge(true, NEAR_WRAP + 400);
+		capture.onEdge(true, NEAR_WRAP + 500); // a repeated rising edge doesn't move the start of the pulse
+		capture.onEdge(false, NEAR_WRAP + 900);
+		checkResult(capture, "stale", 500, 900);
+
+		capture.onEdge(true, NEAR_WRAP + 1000);
+		capture.onEdge(false, NEAR_WRAP + 1200);
+		check(!capture.isBusy(), "stale", "an edge restarted a finished measurement");
+		checkNoResult(capture, "stale");
+	}
+
+	void testMissing(){
+		EchoCapture capture;
+
+		// no echo at all
+		capture.start(NEAR_WRAP, TIMEOUT_US);
+		capture.poll(NEAR_WRAP + TIMEOUT_US - 1);
+		checkNoResult(capture, "missing");
+		check(capture.isBusy(), "missing", "timed out early");
+		capture.poll(NEAR_WRAP + TIMEOUT_US);
+		checkResult(capture, "missing", EchoCapture::TIMEOUT, TIMEOUT_US);
+
+		// the echo starts but doesn't end within the window
+		capture.start(NEAR_WRAP + 50000, TIMEOUT_US);
+		capture.onEdge(true, NEAR_WRAP + 50000 + 29000);
+		capture.poll(NEAR_WRAP + 50000 + TIMEOUT_US + 5);
+		capture.onEdge(false, NEAR_WRAP + 50000 + TIMEOUT_US + 7); // after the timeout was taken
+		checkResult(capture, "missing", EchoCapture::TIMEOUT, TIMEOUT_US);
+	}
+
+	void testRace(){
+		EchoCapture capture;
+
+		// the interrupt first: the poll right after it finds the measurement finished
+		capture.start(NEAR_WRAP, TIMEOUT_US);
+		capture.onEdge(true, NEAR_WRAP + 200);
+		capture.onEdge(false, NEAR_WRAP + TIMEOUT_US - 1);
+		capture.poll(NEAR_WRAP + TIMEOUT_US);
+		checkResult(capture, "race", TIMEOUT_US - 201, TIMEOUT_US - 1);
+
+		// the poll first: the last edge inside the window comes in after the timeout was taken
+		capture.start(NEAR_WRAP, TIMEOUT_US);
+		capture.onEdge(true, NEAR_WRAP + 200);
+		capture.poll(NEAR_WRAP + TIMEOUT_US);
+		capture.onEdge(false, NEAR_WRAP + TIMEOUT_US - 1);
+		checkResult(capture, "race", EchoCapture::TIMEOUT, TIMEOUT_US);
+	}
+
+	/// The interrupt on a thread of its own, the timestamps of its edges lie at the end of the window while the main
+	/// thread polls it, so either side may finish the measurement
+	void testThreadedRace(const int measurements){
+		EchoCapture capture;
+		std::atomic<int> started{0};
+		std::atomic<int> handled{0};
+		std::atomic<uint32_t> triggerTime{0};
+
+		std::thread interrupt([&]{
+			std::minstd_rand random(3);
+			for(int measurement = 1; measurement <= measurements; measurement++){
+				while(started.load(std::memory_order_acquire) < measurement) std::this_thread::yield();
+
+				const uint32_t trigger = triggerTime.load(std::memory_order_relaxed);
+				for(volatile int spin = random() % 200; spin > 0; spin--){}
+				capture.onEdge(true, trigger + 100);
+				for(volatile int spin = random() % 200; spin > 0; spin--){}
+				capture.onEdge(false, trigger + TIMEOUT_US - 1);
+				handled.store(measurement, std::memory_order_release);
+			}
+		});
+
+		std::minstd_rand random(5);
+		int echoes = 0, timeouts = 0, wrong = 0;
+		uint32_t trigger = NEAR_WRAP - 1000u * 37003u;
+		for(int measurement = 1; measurement <= measurements; measurement++){
+			trigger += 37003; // wraps part way through
+			if(!capture.start(trigger, TIMEOUT_US)) wrong++;
+			triggerTime.store(trigger, std::memory_order_relaxed);
+			started.store(measurement, std::memory_order_release);
+
+			// the main loop comes by inside the window a few times, handing the core over to the interrupt in between
+			for(int early = random() % 3; early > 0; early--){
+				capture.poll(trigger + TIMEOUT_US - 2);
+				std::this_thread::yield();
+			}
+			while(capture.isBusy()) capture.poll(trigger + TIMEOUT_US);
+
+			int32_t pulse;
+			uint32_t listen;
+			if(!capture.takeResult(pulse, listen)) wrong++;
+			else if(pulse == EchoCapture::TIMEOUT && listen == TIMEOUT_US) timeouts++;
+			else if(pulse == static_cast<int32_t>(TIMEOUT_US) - 101 && listen == TIMEOUT_US - 1) echoes++;
+			else wrong++;
+
+			// edges of this measurement must not reach the next one
+			while(handled.load(std::memory_order_acquire) < measurement) std::this_thread::yield();
+			if(capture.takeResult(pulse)) wrong++;
+		}
+		interrupt.join();
+
+		printf("threads: %d measurements, %d echoes, %d timeouts, %d wrong\n", measurements, echoes, timeouts, wrong);
+		check(wrong == 0, "threads", "a measurement without exactly one right result");
+	}
+}
+
+int main(int argc, char** argv){
+	int measurements = 200000;
+
+	int option;
+	while((option = getopt(argc, argv, "n:h")) != -1){
+		switch(option){
+			case 'n': measurements = atoi(optarg); break;
+			default: printUsage(argv[0]); return option == 'h' ? 0 : 1;
+		}
+	}
+
+	testEcho();
+	testStale();
+	testMissing();
+	testRace();
+	testThreadedRace(measurements);
+
+	printf("echo capture: %s\n", failures == 0 ? "passed" : "FAILED");
+	return failures == 0 ? 0 : 1;
+}
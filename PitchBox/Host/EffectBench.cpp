@@ -0,0 +1,300 @@
+#include "daisysp.h"
+
+#include "Effects/Chorus.h"
+#include "Effects/EffectChain.h"
+#include "Effects/LowPass.h"
+#include "Effects/OversampledOverdrive.h"
+#include "Mappings/Knobs.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <unistd.h>
+#include <vector>
+
+/*
+Speed of the effects after the voice mix, each stage alone and the whole chain in the configurations the instrument
+plays in. The original per-sample loop of DspCore, which checked both effects on every sample, is the reference:
+	original     overdrive and chorus blended per sample, then the low pass
+	stage        one stage alone, processing whole blocks
+	chain        the EffectChain with both effects bypassed, both on, and toggled every 20 ms (always fading), with
+	             the stereo output of the chorus
+The input is a few seconds of a chord of sines, the wet amount and the cutoff are fixed unless stated.
+
+The low pass is measured resting and sweeping (a new cutoff every 20 blocks), against the DaisySP Tone it replaced,
+which recomputed its coefficients with cosf and sqrtf every 16 samples while the cutoff moved.
+
+The chorus is measured against the DaisySP Chorus it replaced, per sample and with the left channel only. The
+new one runs three taps on one line, mono (the average of its channels) and stereo.
+
+The overdrive is measured at every oversampling factor up to the one it's built for (OVERSAMPLING=4 for all),
+together with its aliasing: a 3010 Hz sine is driven hard and everything below 16 kHz which isn't one of its harmonics is
+aliasing. The level is relative to the whole output. The halfband filters pass up to 18 kHz, what folds back
+into their transition band lands above it.
+*/
+
+namespace {
+	const float SAMPLE_RATE = 48000.f;
+	const size_t BLOCK_SIZE = 48;
+	const float WET = 0.5f;
+
+	void printUsage(const char* name){
+		fprintf(stderr,
+			"Usage: %s [-s seconds]\n"
+			"  -s  seconds of audio per run, default 10\n", name);
+	}
+
+	std::vector<float> makeInput(const size_t size){
+		std::vector<float> input(size);
+		for(size_t i = 0; i < size; i++){
+			const float t = static_cast<float>(i) / SAMPLE_RATE;
+			input[i] = 0.3f * sinf(2.f * M_PI * 220.f * t) + 0.2f * sinf(2.f * M_PI * 330.f * t) +
+				0.1f * sinf(2.f * M_PI * 440.f * t);
+		}
+		return input;
+	}
+
+	template <typename Function>
+	double nsPerSample(const std::vector<float>& input, Function&& function){
+		std::vector<float> buffer(input.size());
+		double best = 1e9;
+		for(int run = 0; run < 5; run++){
+			buffer = input;
+			const auto start = std::chrono::steady_clock::now();
+			for(size_t offset = 0; offset + BLOCK_SIZE <= buffer.size(); offset += BLOCK_SIZE){
+				function(buffer.data() + offset, offset / BLOCK_SIZE);
+			}
+			const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			if(seconds < best) best = seconds;
+		}
+
+		volatile float sink = buffer[buffer.size() / 2];
+		(void)sink;
+		return best * 1e9 / input.size();
+	}
+
+	/// The loop DspCore ran before the effect chain
+	struct Original {
+		daisysp::Overdrive overdrive;
+		daisysp::Chorus chorus;
+		daisysp::Tone lowPass;
+
+		Original(){
+			overdrive.Init();
+			overdrive.SetDrive(0.4f);
+			chorus.Init(SAMPLE_RATE);
+			chorus.SetDelay(1.f);
+			chorus.SetFeedback(0.5f);
+			chorus.SetLfoDepth(1.f);
+			chorus.SetLfoFreq(6.5f);
+			lowPass.Init(SAMPLE_RATE);
+			lowPass.SetFreq(8000.f);
+		}
+
+		void process(float* buffer, const size_t size, const bool isOverdriveOn, const bool isChorusOn){
+			for(size_t i = 0; i < size; i++){
+				auto output = buffer[i];
+				if(isOverdriveOn) output = (1 - WET) * output + WET * overdrive.Process(output);
+				if(isChorusOn) output = (1 - WET) * output + WET * chorus.Process(output);
+				buffer[i] = lowPass.Process(output);
+			}
+		}
+	};
+
+	/// Energy of everything below 16 kHz but the harmonics of the input relative to the whole signal, in dB
+	double aliasingOf(OversampledOverdriveStage& overdrive){
+		const size_t size = 4800; // 10 Hz bins
+		const size_t bin = 301;
+		const size_t settle = 960;
+
+		std::vector<float> signal(settle + size);
+		for(size_t i = 0; i < signal.size(); i++){
+			signal[i] = 0.9f * sinf(2.f * M_PI * bin * static_cast<float>(i) / size);
+		}
+		for(size_t offset = 0; offset + BLOCK_SIZE <= signal.size(); offset += BLOCK_SIZE){
+			overdrive.process(signal.data() + offset, BLOCK_SIZE);
+		}
+
+		// every bin below 16 kHz which isn't a harmonic holds aliasing, relative to the energy of all bins
+		const float* output = signal.data() + settle;
+		double total = 0.;
+		for(size_t i = 0; i < size; i++) total += output[i] * output[i];
+		total *= size / 2.;
+
+		double aliases = 0.;
+		for(size_t k = 1; k < size / 3; k++){ // 16 kHz
+			if(k % bin == 0) continue;
+			double re = 0., im = 0.;
+			for(size_t i = 0; i < size; i++){
+				const double phase = 2. * M_PI * static_cast<double>(k * i % size) / size;
+				re += output[i] * cos(phase);
+				im += output[i] * sin(phase);
+			}
+			aliases += re * re + im * im;
+		}
+
+		return 10. * log10(aliases / total);
+	}
+
+	/// In the order of DspCore
+	struct Chain {
+		OversampledOverdriveStage overdrive;
+		LowPassStage lowPass;
+		ChorusStage chorus;
+		ChorusStage::Line chorusLine;
+		EffectChain effects;
+		int overdriveStage;
+		int chorusStage;
+		float right[BLOCK_SIZE];
+
+		Chain(){
+			overdriveStage = effects.addStage(overdrive, EffectChain::Blend::MIXED);
+			effects.addStage(lowPass, EffectChain::Blend::WET, true);
+			chorusStage = effects.addStage(chorus, EffectChain::Blend::MIXED);
+			chorus.setLine(&chorusLine);
+			effects.init(SAMPLE_RATE);
+			effects.setWet(WET);
+			lowPass.setCutoff(8000.f);
+		}
+	};
+}
+
+int main(int argc, char** argv){
+	float seconds = 10.f;
+
+	int option;
+	while((option = getopt(argc, argv, "s:h")) != -1){
+		switch(option){
+			case 's': seconds = atof(optarg); break;
+			default: printUsage(argv[0]); return option == 'h' ? 0 : 1;
+		}
+	}
+
+	const auto input = makeInput(static_cast<size_t>(seconds * SAMPLE_RATE));
+
+	Original original;
+	const double originalOff = nsPerSample(input, [&original](float* block, size_t){
+		original.process(block, BLOCK_SIZE, false, false);
+	});
+	const double originalOn = nsPerSample(input, [&original](float* block, size_t){
+		original.process(block, BLOCK_SIZE, true, true);
+	});
+
+	std::unique_ptr<Chain> stages(new Chain());
+	double overdrive[OversampledOverdriveStage::MAX_FACTOR + 1];
+	double aliasing[OversampledOverdriveStage::MAX_FACTOR + 1];
+	for(int factor = 1; factor <= OversampledOverdriveStage::MAX_FACTOR; factor *= 2){
+		stages->overdrive.setFactor(factor);
+		overdrive[factor] = nsPerSample(input, [&stages](float* block, size_t){
+			stages->overdrive.process(block, BLOCK_SIZE);
+		});
+		stages->overdrive.setFactor(factor);
+		aliasing[factor] = aliasingOf(stages->overdrive);
+	}
+	stages->overdrive.setFactor(OversampledOverdriveStage::MAX_FACTOR);
+	daisysp::Chorus daisyChorus;
+	daisyChorus.Init(SAMPLE_RATE);
+	daisyChorus.SetDelay(1.f);
+	daisyChorus.SetFeedback(0.5f);
+	daisyChorus.SetLfoDepth(1.f);
+	daisyChorus.SetLfoFreq(6.5f);
+	const double chorusDaisy = nsPerSample(input, [&daisyChorus](float* __restrict block, size_t){
+		for(size_t i = 0; i < BLOCK_SIZE; i++) block[i] = daisyChorus.Process(block[i]);
+	});
+	const double chorus = nsPerSample(input, [&stages](float* block, size_t){
+		stages->chorus.process(block, BLOCK_SIZE);
+	});
+	const double chorusStereo = nsPerSample(input, [&stages](float* block, size_t){
+		stages->chorus.processStereo(block, stages->right, BLOCK_SIZE);
+	});
+	const double lowPass = nsPerSample(input, [&stages](float* block, size_t){
+		stages->lowPass.process(block, BLOCK_SIZE);
+	});
+	const double lowPassSweep = nsPerSample(input, [&stages](float* block, const size_t index){
+		if(index % 20 == 0) stages->lowPass.setCutoff(index % 40 == 0 ? 2000.f : 12000.f); // always ramping
+		stages->lowPass.process(block, BLOCK_SIZE);
+	});
+	LowPassStage svf;
+	svf.init(SAMPLE_RATE);
+	svf.setMode(LowPassStage::Mode::SVF);
+	svf.setResonance(2.f);
+	svf.setCutoff(8000.f);
+	const double svfRest = nsPerSample(input, [&svf](float* block, size_t){
+		svf.process(block, BLOCK_SIZE);
+	});
+	const double svfSweep = nsPerSample(input, [&svf](float* block, const size_t index){
+		if(index % 20 == 0) svf.setCutoff(index % 40 == 0 ? 2000.f : 12000.f);
+		svf.process(block, BLOCK_SIZE);
+	});
+
+	daisysp::Tone tone;
+	tone.Init(SAMPLE_RATE);
+	Smoothing toneCutoff{25.f, Smoothing::Mode::EXPONENTIAL};
+	toneCutoff.setSampleRate(SAMPLE_RATE);
+	toneCutoff.setCurrentAndTargetValue(8000.f);
+	tone.SetFreq(8000.f);
+	const auto toneProcess = [&tone, &toneCutoff](float* __restrict block){
+		for(size_t i = 0; i < BLOCK_SIZE; i += LowPassStage::UPDATE_INTERVAL){
+			if(toneCutoff.isSmoothing()) tone.SetFreq(toneCutoff.advance(LowPassStage::UPDATE_INTERVAL));
+			for(size_t j = i; j < i + LowPassStage::UPDATE_INTERVAL; j++) block[j] = tone.Process(block[j]);
+		}
+	};
+	const double toneRest = nsPerSample(input, [&toneProcess](float* block, size_t){
+		toneProcess(block);
+	});
+	const double toneSweep = nsPerSample(input, [&toneProcess, &toneCutoff](float* block, const size_t index){
+		if(index % 20 == 0) toneCutoff.setTargetValue(index % 40 == 0 ? 2000.f : 12000.f);
+		toneProcess(block);
+	});
+
+	// accuracy of the approximate tan over the cutoff knob's range, as an error of the cutoff
+	double maxCents = 0.;
+	for(float cutoff = mapping::MIN_CUTOFF; cutoff <= mapping::MAX_CUTOFF; cutoff += 10.f){
+		const double approximate = lowpass::tan(static_cast<float>(M_PI) * cutoff / SAMPLE_RATE);
+		const double warped = atan(approximate) * SAMPLE_RATE / M_PI;
+		maxCents = fmax(maxCents, fabs(1200. * log2(warped / cutoff)));
+	}
+
+	std::unique_ptr<Chain> chain(new Chain());
+	const double bypassed = nsPerSample(input, [&chain](float* block, size_t){
+		chain->effects.process(block, chain->right, BLOCK_SIZE);
+	});
+	chain->effects.setEnabled(chain->overdriveStage, true);
+	chain->effects.setEnabled(chain->chorusStage, true);
+	const double on = nsPerSample(input, [&chain](float* block, size_t){
+		chain->effects.process(block, chain->right, BLOCK_SIZE);
+	});
+	const double toggled = nsPerSample(input, [&chain](float* block, const size_t index){
+		if(index % 20 == 0){ // the fades take 5 ms, one toggle every 20 ms keeps them going most of the time
+			const bool isOn = index % 40 == 0;
+			chain->effects.setEnabled(chain->overdriveStage, isOn);
+			chain->effects.setEnabled(chain->chorusStage, isOn);
+		}
+		chain->effects.process(block, chain->right, BLOCK_SIZE);
+	});
+
+	printf("%zu-sample blocks, ns/sample\n", BLOCK_SIZE);
+	printf("%-30s %6.2f\n", "original, effects off", originalOff);
+	printf("%-30s %6.2f\n", "original, effects on", originalOn);
+	for(int factor = 1; factor <= OversampledOverdriveStage::MAX_FACTOR; factor *= 2){
+		char name[32];
+		snprintf(name, sizeof(name), "stage overdrive %dx", factor);
+		printf("%-30s %6.2f   aliasing %6.1f dB\n", name, overdrive[factor], aliasing[factor]);
+	}
+	printf("%-30s %6.2f\n", "DaisySP chorus", chorusDaisy);
+	printf("%-30s %6.2f\n", "stage chorus, mono", chorus);
+	printf("%-30s %6.2f\n", "stage chorus, stereo", chorusStereo);
+	printf("%-30s %6.2f\n", "Tone", toneRest);
+	printf("%-30s %6.2f\n", "Tone, sweeping", toneSweep);
+	printf("%-30s %6.2f\n", "stage low pass", lowPass);
+	printf("%-30s %6.2f\n", "stage low pass, sweeping", lowPassSweep);
+	printf("%-30s %6.2f\n", "stage low pass SVF", svfRest);
+	printf("%-30s %6.2f\n", "stage low pass SVF, sweeping", svfSweep);
+	printf("%-30s %6.2f\n", "chain, effects bypassed", bypassed);
+	printf("%-30s %6.2f\n", "chain, effects on", on);
+	printf("%-30s %6.2f\n", "chain, effects toggling", toggled);
+	printf("approximate tan: cutoffs %g - %g Hz within %.3f cents\n", mapping::MIN_CUTOFF, mapping::MAX_CUTOFF, maxCents);
+	return 0;
+}
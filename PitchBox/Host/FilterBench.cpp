@@ -0,0 +1,226 @@
+#include "Ultrasonic/DistanceFilter.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <unistd.h>
+
+/*
+Quality and speed of the DistanceFilter stages on a trace of raw sensor readings.
+
+Trace format, one measurement per line, '#' starts a comment:
+	time_ms  raw_mm  [true_mm]
+raw_mm is negative on a timeout. true_mm is the real hand position if known (negative = no hand), the quality
+figures are only computed for traces which have it, e.g. the synthetic one and those in Traces/.
+
+On a trace with true_mm the new filters have to beat the one pole lowpass they replaced, both in RMS error and in
+wrong notes, and the Kalman filter has to play less than MAX_KALMAN_WRONG_NOTES wrong notes. Exits with 1 if one
+of them doesn't.
+*/
+
+namespace {
+	struct Reading {
+		float time; // ms
+		float raw;
+		float truth;
+	};
+
+	/// Half the distance between two notes of the pitch mapping, more than that plays a wrong note
+	const float WRONG_NOTE_ERROR = 800.f / 12.f * 0.5f;
+
+	/// Share of the readings, 0.04 % on the 60 s synthetic trace and 0.28 % on 600 s
+	const float MAX_KALMAN_WRONG_NOTES = 0.01f;
+
+	/// Quality figures of a filter on a trace, only valid if compared > 0
+	struct Quality {
+		double rms;
+		float maxError;
+		float wrongNotes; // share of the compared readings
+		int compared;
+	};
+
+	void printUsage(const char* name){
+		fprintf(stderr,
+			"Usage: %s (-t trace.txt | -s seconds) [-d dump.txt]\n"
+			"  -t  filter a recorded trace\n"
+			"  -s  generate a synthetic trace of given length\n"
+			"  -d  write the trace to a file\n", name);
+	}
+
+	bool loadTrace(const char* path, std::vector<Reading>& trace){
+		FILE* file = fopen(path, "r");
+		if(!file){
+			fprintf(stderr, "Can't open %s\n", path);
+			return false;
+		}
+
+		char line[256];
+		while(fgets(line, sizeof(line), file)){
+			if(char* comment = strchr(line, '#')) *comment = '\0';
+
+			Reading reading{0.f, 0.f, NAN};
+			if(sscanf(line, "%f %f %f", &reading.time, &reading.raw, &reading.truth) >= 2) trace.push_back(reading);
+		}
+
+		fclose(file);
+		return true;
+	}
+
+	void saveTrace(const char* path, const std::vector<Reading>& trace){
+		FILE* file = fopen(path, "w");
+		if(!file){
+			fprintf(stderr, "Can't create %s\n", path);
+			return;
+		}
+
+		fprintf(file, "# time_ms raw_mm true_mm\n");
+		for(const auto& reading: trace) fprintf(file, "%.3f %.2f %.2f\n", reading.time, reading.raw, reading.truth);
+		fclose(file);
+	}
+
+	/// A hand jumping between notes with quick (~200 ms) movements, holding each with a slight tremor, and leaving the
+	/// range now and then. Readings come every 12 ms like from the ping scheduler, with 2 mm of noise, 3 % timeouts
+	/// and 2 % spurious echoes.
+	void generateTrace(const float seconds, std::vector<Reading>& trace){
+		std::mt19937 random(1234);
+		std::normal_distribution<float> noise(0.f, 2.f);
+		std::uniform_real_distribution<float> uniform(0.f, 1.f);
+
+		float from = 500.f, to = 500.f;
+		float moveStart = 0.f, moveLength = 0.2f, holdUntil = 0.5f;
+		bool isGone = false;
+
+		for(float t = 0.f; t < seconds; t += 0.012f){
+			if(t >= holdUntil){
+				isGone = !isGone && uniform(random) < 0.1f;
+				from = to;
+				to = 200.f + uniform(random) * 800.f;
+				moveStart = t;
+				moveLength = 0.1f + uniform(random) * 0.3f;
+				holdUntil = t + moveLength + 0.2f + uniform(random) * 0.8f;
+			}
+
+			// minimum jerk movement, then a 5 Hz tremor
+			const float x = fminf((t - moveStart) / moveLength, 1.f);
+			const float shape = x * x * x * (10.f - 15.f * x + 6.f * x * x);
+			const float truth = isGone ? -1.f : from + (to - from) * shape + 1.5f * sinf(2.f * 3.14159265f * 5.f * t);
+
+			float raw = truth + noise(random);
+			const float event = uniform(random);
+			if(isGone || event < 0.03f) raw = -0.343f; // what a timeout reads as
+			else if(event < 0.05f) raw = 50.f + uniform(random) * 1150.f;
+
+			trace.push_back({t * 1000.f, raw, truth});
+		}
+	}
+
+	Quality evaluate(const char* name, DistanceFilter& filter, const std::vector<Reading>& trace){
+		filter.reset();
+
+		double squaredError = 0.0;
+		float maxError = 0.f;
+		int compared = 0, wrongNotes = 0;
+		float previousTime = trace.front().time;
+
+		for(const auto& reading: trace){
+			const float dt = (reading.time - previousTime) * 0.001f;
+			previousTime = reading.time;
+
+			const float value = filter.process(reading.raw, dt);
+			if(std::isnan(reading.truth) || reading.truth < 0.f) continue;
+
+			// the firmware clamps reported timeouts to 0
+			const float error = fabsf((value < 0.f ? 0.f : value) - reading.truth);
+			squaredError += error * error;
+			if(error > maxError) maxError = error;
+			if(error > WRONG_NOTE_ERROR) wrongNotes++;
+			compared++;
+		}
+
+		// speed, best of a few runs over the whole trace
+		double best = 1e9;
+		volatile float sink = 0.f;
+		for(int run = 0; run < 20; run++){
+			filter.reset();
+			const auto start = std::chrono::steady_clock::now();
+			for(const auto& reading: trace) sink = sink + filter.process(reading.raw, 0.012f);
+			const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			if(seconds < best) best = seconds;
+		}
+
+		const Quality quality{compared > 0 ? sqrt(squaredError / compared) : 0.0, maxError,
+			compared > 0 ? static_cast<float>(wrongNotes) / compared : 0.f, compared};
+		printf("%-16s %6.1f ns/update", name, best * 1e9 / trace.size());
+		if(compared > 0){
+			printf("  rms %6.2f mm  max %7.1f mm  wrong note %5.2f %%", quality.rms, quality.maxError,
+				100.f * quality.wrongNotes);
+		}
+		printf("\n");
+		return quality;
+	}
+
+	/// A new filter has to be better than the one pole reference in both figures
+	bool isBetter(const char* name, const Quality& quality, const Quality& reference){
+		const bool isOk = quality.rms < reference.rms && quality.wrongNotes < reference.wrongNotes;
+		if(!isOk) printf("FAILED: %s isn't better than the one pole filter\n", name);
+		return isOk;
+	}
+}
+
+int main(int argc, char** argv){
+	const char* tracePath = nullptr;
+	const char* dumpPath = nullptr;
+	float seconds = 0.f;
+
+	int option;
+	while((option = getopt(argc, argv, "t:s:d:h")) != -1){
+		switch(option){
+			case 't': tracePath = optarg; break;
+			case 's': seconds = strtof(optarg, nullptr); break;
+			case 'd': dumpPath = optarg; break;
+			default: printUsage(argv[0]); return option == 'h' ? 0 : 1;
+		}
+	}
+
+	std::vector<Reading> trace;
+	if(tracePath){
+		if(!loadTrace(tracePath, trace)) return 1;
+	}
+	else if(seconds > 0.f){
+		generateTrace(seconds, trace);
+	}
+	if(trace.empty()){
+		printUsage(argv[0]);
+		return 1;
+	}
+	if(dumpPath) saveTrace(dumpPath, trace);
+
+	printf("%zu readings\n", trace.size());
+
+	OnePoleFilter onePole(0.5f);
+	MedianFilter median(5);
+	KalmanFilter kalman;
+
+	const auto onePoleQuality = evaluate("one pole (old)", onePole, trace);
+	const auto medianQuality = evaluate("median 5", median, trace);
+	const auto kalmanQuality = evaluate("kalman", kalman, trace);
+
+	if(onePoleQuality.compared == 0){
+		printf("no true positions in the trace, nothing checked\n");
+		return 0;
+	}
+
+	bool isOk = isBetter("median 5", medianQuality, onePoleQuality);
+	isOk = isBetter("kalman", kalmanQuality, onePoleQuality) && isOk;
+	if(kalmanQuality.wrongNotes >= MAX_KALMAN_WRONG_NOTES){
+		printf("FAILED: kalman plays %.2f %% wrong notes, limit %.0f %%\n", 100.f * kalmanQuality.wrongNotes,
+			100.f * MAX_KALMAN_WRONG_NOTES);
+		isOk = false;
+	}
+	printf("filter quality: %s\n", isOk ? "passed" : "FAILED");
+	return isOk ? 0 : 1;
+}
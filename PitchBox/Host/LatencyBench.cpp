@@ -0,0 +1,174 @@
+#include "MockHal.h"
+#include "Ultrasonic/PingScheduler.h"
+#include "Ultrasonic/DistanceFilter.h"
+#include "Ultrasonic/HandPredictor.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+#include <unistd.h>
+
+/*
+End-to-end latency of the pitch hand: from where the hand is to the distance the DSP core maps the pitch from.
+Simulates the whole chain on a synthetic performance: the ping scheduler with the time of flight of both sensors,
+the Kalman filter, the predictor, the controls handed to the core and its per-callback smoothing.
+
+The latency is the delay which best aligns the core's distance with the real hand position, the error is what is
+left after that alignment (overshoot, jitter). Both are reported for every lead time given with -l.
+*/
+
+namespace {
+	const float SAMPLE_RATE = 48000.f;
+	const int BLOCK_SIZE = 48;
+	const float VOLUME_HAND = 600.f; // mm, the other hand holds still
+
+	void printUsage(const char* name){
+		fprintf(stderr,
+			"Usage: %s [-s seconds] [-l leadMs]...\n"
+			"  -s  length of the performance, default 60\n"
+			"  -l  lead time of the predictor to measure, may be repeated, default 0 and 20\n", name);
+	}
+
+	/// Hand position in mm at every audio block: quick note changes of 100 - 400 ms between holds with a tremor
+	void generateHand(const float seconds, std::vector<float>& hand){
+		std::mt19937 random(4321);
+		std::uniform_real_distribution<float> uniform(0.f, 1.f);
+
+		float from = 500.f, to = 500.f;
+		float moveStart = 0.f, moveLength = 0.2f, holdUntil = 0.5f;
+		const float blockTime = BLOCK_SIZE / SAMPLE_RATE;
+
+		for(float t = 0.f; t < seconds; t += blockTime){
+			if(t >= holdUntil){
+				from = to;
+				to = 250.f + uniform(random) * 700.f;
+				moveStart = t;
+				moveLength = 0.1f + uniform(random) * 0.3f;
+				holdUntil = t + moveLength + 0.2f + uniform(random) * 0.6f;
+			}
+
+			const float x = fminf((t - moveStart) / moveLength, 1.f);
+			const float shape = x * x * x * (10.f - 15.f * x + 6.f * x * x);
+			hand.push_back(from + (to - from) * shape + 1.5f * sinf(2.f * 3.14159265f * 5.f * t));
+		}
+	}
+
+	/// Runs the chain, returns the core's pitch distance at every block
+	void simulate(const std::vector<float>& hand, const float leadTime, std::vector<float>& output){
+		std::mt19937 random(99);
+		std::normal_distribution<float> noise(0.f, 2.f);
+
+		std::unique_ptr<DspCore> core(new DspCore());
+		core->init(SAMPLE_RATE);
+
+		MockHal hal;
+		hal.setKnob(DspCore::MASTER_VOLUME, 0.8f);
+		hal.setKnob(DspCore::ANCHORS_SIZE, 0.5f);
+		hal.setKnob(DspCore::CUTOFF, 0.7f);
+		hal.setDistances(hand.front(), VOLUME_HAND);
+		hal.publish(*core);
+
+		PingScheduler scheduler;
+		KalmanFilter filter;
+		HandPredictor predictor;
+		predictor.setLeadTime(leadTime);
+
+		const double blockUs = BLOCK_SIZE * 1e6 / SAMPLE_RATE;
+		float left[BLOCK_SIZE], right[BLOCK_SIZE];
+		float* out[2] = {left, right};
+
+		int sensor = -1;
+		uint32_t echoEnd = 0, listen = 0, previousTrigger = 0, trigger = 0;
+		float measured = 0.f;
+		output.clear();
+
+		// the main loop runs much faster than the audio, step it every 20 µs
+		for(uint32_t now = 0, block = 0; block < hand.size(); now += 20){
+			if(sensor >= 0 && now >= echoEnd){
+				scheduler.onResult(sensor, 1, listen, now);
+				if(sensor == 0){
+					const float distance = filter.process(measured, (trigger - previousTrigger) * 1e-6f);
+					predictor.update(distance, filter.getVelocity(), now - static_cast<uint32_t>(measured / .343f * 0.5f));
+					hal.setDistances(predictor.predict(now), VOLUME_HAND);
+					hal.publish(*core);
+				}
+				sensor = -1;
+			}
+
+			uint32_t timeout;
+			const int next = scheduler.next(now, timeout);
+			if(next >= 0){
+				// the sound reaches the hand halfway through the time of flight, the sensor adds ~450 µs before that
+				const size_t handBlock = static_cast<size_t>(now / blockUs);
+				const float distance = next == 0 ? hand[handBlock < hand.size() ? handBlock : hand.size() - 1] : VOLUME_HAND;
+				listen = 450 + static_cast<uint32_t>(distance / .343f);
+				echoEnd = now + listen;
+				if(next == 0){
+					previousTrigger = trigger;
+					trigger = now;
+					measured = distance + noise(random);
+				}
+				sensor = next;
+				scheduler.onPing(next, now);
+			}
+
+			if(now >= (block + 1) * blockUs){
+				core->process(out, BLOCK_SIZE);
+				output.push_back(core->getPitchDistance());
+				block++;
+			}
+		}
+	}
+
+	/// Finds the delay (in blocks) which best aligns output with hand, returns the RMS error at it
+	float alignment(const std::vector<float>& hand, const std::vector<float>& output, int& bestDelay){
+		const int maxDelay = 150;
+		const size_t skip = 2 * maxDelay; // the start up, and every delay compares the same blocks
+		float bestError = 1e9f;
+		for(int delay = 0; delay < maxDelay; delay++){
+			double error = 0.0;
+			for(size_t i = skip; i < output.size(); i++){
+				const float e = output[i] - hand[i - delay];
+				error += e * e;
+			}
+			error = sqrt(error / (output.size() - skip));
+			if(error < bestError){
+				bestError = static_cast<float>(error);
+				bestDelay = delay;
+			}
+		}
+		return bestError;
+	}
+}
+
+int main(int argc, char** argv){
+	float seconds = 60.f;
+	std::vector<float> leadTimes;
+
+	int option;
+	while((option = getopt(argc, argv, "s:l:h")) != -1){
+		switch(option){
+			case 's': seconds = strtof(optarg, nullptr); break;
+			case 'l': leadTimes.push_back(strtof(optarg, nullptr) * 0.001f); break;
+			default: printUsage(argv[0]); return option == 'h' ? 0 : 1;
+		}
+	}
+	if(leadTimes.empty()) leadTimes = {0.f, HandPredictor::Config().leadTime};
+
+	std::vector<float> hand, output;
+	generateHand(seconds, hand);
+
+	const float blockMs = BLOCK_SIZE * 1000.f / SAMPLE_RATE;
+	for(const float leadTime: leadTimes){
+		simulate(hand, leadTime, output);
+
+		int delay = 0;
+		const float error = alignment(hand, output, delay);
+		printf("lead %5.1f ms: latency %5.1f ms, error after alignment %5.2f mm rms\n", leadTime * 1000.f,
+			delay * blockMs, error);
+	}
+	return 0;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "Core/DspCore.h"
+
+/// @brief Stand-in for the Daisy hardware of PitchBox.cpp on the host. Holds the state of the buttons, the knobs
+/// and the ultrasonic sensors and hands it to the DSP core exactly like the firmware's main loop does.
+class MockHal {
+public:
+	MockHal() = default;
+	~MockHal() = default;
+
+	/// @brief Presses or releases a button of given handle (0 or 1)
+	void setButton(const int handle, const DspCore::Button button, const bool pressed) { controls.setPressed(handle, button, pressed); }
+
+	/// @brief Sets the side of the left/right switch, see DspCore::Controls::isLeftRight
+	void setLeftRight(const bool isLeftRight) { controls.isLeftRight = isLeftRight; }
+
+	/// @brief Sets a raw knob reading, 0 - 1
+	void setKnob(const DspCore::Knob knob, const float value0To1) { controls.knobs[knob] = value0To1; }
+
+	/// @brief Sets the distances measured by the sensors in mm, negative values simulate a timeout
+	void setDistances(const float pitch, const float volume){
+		controls.distancePitch = pitch;
+		controls.distanceVolume = volume;
+	}
+
+	/// @brief Sends the current state of all controls to the core
+	void publish(DspCore& core) const { core.setControls(controls); }
+
+	const DspCore::Controls& getControls() const { return controls; }
+
+private:
+	DspCore::Controls controls;
+};
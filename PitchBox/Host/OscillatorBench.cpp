@@ -0,0 +1,116 @@
+#include "FM/Oscillator.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+/*
+Drift and speed of the oscillator's phase accumulator against the float accumulator it replaced:
+	float   phase and step in cycles as floats, wrapped by subtracting 1
+	fixed   Oscillator, 32 bit fixed point, wrapped by overflow
+Both run at the lowest carrier (note 36, 65.4 Hz) for an hour of samples at 48 kHz. The phase they end at is compared
+with the exact phase of the frequency. For the float accumulator it is also compared with the exact phase of its own
+(float rounded) step, which only the rounding of the accumulation moves away from.
+
+The fixed-point step is set at full precision, rounded to the nearest 2^-32 cycles, so it is off by at most 2^-33
+cycles per sample and the accumulation itself is exact. Its error after n samples is bounded by n * 2^-33 cycles
+(0.02 cycles for the hour), exits with 1 if it is larger.
+
+The throughput runs the accumulators alone over (at most) 100 s of samples, every phase is used so the loops aren't
+optimised away.
+*/
+
+namespace {
+	const double SAMPLE_RATE = 48000.;
+	const double FREQUENCY = 65.40639; // note 36
+
+	void printUsage(const char* name){
+		fprintf(stderr,
+			"Usage: %s [-s seconds]\n"
+			"  -s  seconds of simulated audio, default 3600\n", name);
+	}
+
+	/// The accumulator of Oscillator before it went fixed point
+	struct FloatOscillator {
+		float phase{0.f};
+		float step{0.f};
+
+		float getNextPhaseValue(){
+			phase += step;
+			if(phase > 1.f) phase -= 1.f;
+			return phase;
+		}
+	};
+
+	/// Distance of two phases in cycles, across the wrap
+	double cyclesBetween(const double a, const double b){
+		const double difference = fabs(a - b);
+		return fmin(difference, 1. - difference);
+	}
+
+	template <typename Function>
+	double nsPerSample(const uint64_t samples, Function&& function){
+		double best = 1e9;
+		volatile float sink = 0.f;
+		for(int run = 0; run < 3; run++){
+			const auto start = std::chrono::steady_clock::now();
+			sink = sink + function(samples);
+			const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			if(seconds < best) best = seconds;
+		}
+		return best * 1e9 / samples;
+	}
+}
+
+int main(int argc, char** argv){
+	double seconds = 3600.;
+
+	int option;
+	while((option = getopt(argc, argv, "s:h")) != -1){
+		switch(option){
+			case 's': seconds = atof(optarg); break;
+			default: printUsage(argv[0]); return option == 'h' ? 0 : 1;
+		}
+	}
+
+	const uint64_t samples = static_cast<uint64_t>(seconds * SAMPLE_RATE);
+	const double exact = fmod(FREQUENCY / SAMPLE_RATE * samples, 1.);
+	const uint32_t fixedStep = static_cast<uint32_t>(llround(FREQUENCY / SAMPLE_RATE * 4294967296.));
+	const double bound = ldexp(static_cast<double>(samples), -33);
+
+	FloatOscillator floatOsc;
+	floatOsc.step = static_cast<float>(FREQUENCY / SAMPLE_RATE);
+	for(uint64_t i = 0; i < samples; i++) floatOsc.getNextPhaseValue();
+	const double floatOwn = fmod(static_cast<double>(floatOsc.step) * samples, 1.);
+
+	Oscillator fixedOsc;
+	fixedOsc.setFixedStep(fixedStep);
+	for(uint64_t i = 0; i < samples; i++) fixedOsc.getNextFixedPhase();
+	const double fixedError = cyclesBetween(fixedOsc.getFixedPhase() / 4294967296., exact);
+
+	const bool isOk = fixedError <= bound;
+	printf("%.0f s at %.0f Hz, %.2f Hz, phase error in cycles\n", seconds, SAMPLE_RATE, FREQUENCY);
+	printf("%-6s %14s %14s %14s\n", "", "own step", "frequency", "bound");
+	printf("%-6s %14.3e %14.3e\n", "float", cyclesBetween(floatOsc.phase, floatOwn), cyclesBetween(floatOsc.phase, exact));
+	printf("%-6s %14s %14.3e %14.3e%s\n", "fixed", "exact", fixedError, bound, isOk ? "" : "  FAILED");
+
+	const uint64_t timed = static_cast<uint64_t>(fmin(seconds, 100.) * SAMPLE_RATE);
+	const double floatNs = nsPerSample(timed, [](const uint64_t count){
+		FloatOscillator osc;
+		osc.step = static_cast<float>(FREQUENCY / SAMPLE_RATE);
+		float sum = 0.f;
+		for(uint64_t i = 0; i < count; i++) sum += osc.getNextPhaseValue();
+		return sum;
+	});
+	const double fixedNs = nsPerSample(timed, [fixedStep](const uint64_t count){
+		Oscillator osc;
+		osc.setFixedStep(fixedStep);
+		uint32_t sum = 0;
+		for(uint64_t i = 0; i < count; i++) sum ^= osc.getNextFixedPhase();
+		return static_cast<float>(sum);
+	});
+	printf("throughput: float %.2f ns/sample, fixed %.2f ns/sample\n", floatNs, fixedNs);
+	return isOk ? 0 : 1;
+}
@@ -0,0 +1,222 @@
+#include "MockHal.h"
+#include "WavWriter.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <unistd.h>
+
+/*
+Offline renderer of the PitchBox DSP core. Replays a timeline of control readings through MockHal and renders
+what AudioCallback would output into a WAV file, as fast as possible.
+
+Trace format, one reading of all controls per line, '#' starts a comment:
+	time_ms  distancePitch  distanceVolume  knob0 knob1 knob2 knob3 knob4  buttons  isLeftRight
+distances are in mm (negative = sensor timeout), knobs are raw 0 - 1 readings, buttons is the
+DspCore::Controls bitmask (decimal or 0x hex). A reading holds until the next one, like in the firmware's main loop.
+*/
+
+namespace {
+	struct Reading {
+		float time; // ms
+		DspCore::Controls controls;
+	};
+
+	void printUsage(const char* name){
+		fprintf(stderr,
+			"Usage: %s (-t trace.txt | -s seconds) [-o out.wav] [-r sampleRate] [-b blockSize] [-d dump.txt] [-p]\n"
+			"  -t  replay a recorded trace\n"
+			"  -s  generate a synthetic performance of given length\n"
+			"  -o  output WAV file, nothing is written without it\n"
+			"  -r  sample rate, default 48000\n"
+			"  -b  audio callback size, default 48 like the firmware\n"
+			"  -d  write the replayed timeline to a trace file\n"
+			"  -p  print the profiler's report of every second of audio, see Core/Profiler.h\n", name);
+	}
+
+	bool loadTrace(const char* path, std::vector<Reading>& timeline){
+		FILE* file = fopen(path, "r");
+		if(!file){
+			fprintf(stderr, "Can't open %s\n", path);
+			return false;
+		}
+
+		char line[512];
+		int lineNumber = 0;
+		while(fgets(line, sizeof(line), file)){
+			lineNumber++;
+			if(char* comment = strchr(line, '#')) *comment = '\0';
+
+			Reading reading;
+			auto& c = reading.controls;
+			char buttons[32];
+			int isLeftRight = 0;
+			const int count = sscanf(line, "%f %f %f %f %f %f %f %f %31s %d", &reading.time,
+				&c.distancePitch, &c.distanceVolume, &c.knobs[0], &c.knobs[1], &c.knobs[2], &c.knobs[3], &c.knobs[4],
+				buttons, &isLeftRight);
+
+			if(count <= 0) continue; // empty line
+			if(count != 10){
+				fprintf(stderr, "%s:%d: expected 10 values, got %d\n", path, lineNumber, count);
+				fclose(file);
+				return false;
+			}
+
+			c.buttons = static_cast<uint16_t>(strtoul(buttons, nullptr, 0));
+			c.isLeftRight = isLeftRight != 0;
+			timeline.push_back(reading);
+		}
+
+		fclose(file);
+		return true;
+	}
+
+	void saveTrace(const char* path, const std::vector<Reading>& timeline){
+		FILE* file = fopen(path, "w");
+		if(!file){
+			fprintf(stderr, "Can't create %s\n", path);
+			return;
+		}
+
+		fprintf(file, "# time_ms distancePitch distanceVolume knob0 knob1 knob2 knob3 knob4 buttons isLeftRight\n");
+		for(const auto& reading: timeline){
+			const auto& c = reading.controls;
+			fprintf(file, "%.9g %.9g %.9g %.9g %.9g %.9g %.9g %.9g 0x%03x %d\n", reading.time,
+				c.distancePitch, c.distanceVolume, c.knobs[0], c.knobs[1], c.knobs[2], c.knobs[3], c.knobs[4],
+				c.buttons, c.isLeftRight ? 1 : 0);
+		}
+		fclose(file);
+	}
+
+	/// A player sweeping the whole range with the pitch hand while cycling through the intervals and effects.
+	/// Readings come every 10 ms, roughly the rate of the firmware's main loop.
+	void generateTrace(const float seconds, std::vector<Reading>& timeline){
+		const int intervalButtons[] = {-1, DspCore::LEFT_MIDDLE, DspCore::LEFT_TOP, DspCore::BOTTOM, DspCore::RIGHT_TOP};
+		const int numSteps = static_cast<int>(seconds * 100.f);
+
+		MockHal hal;
+		hal.setLeftRight(false); // intervals on handle 1, effects on handle 0
+		hal.setKnob(DspCore::MASTER_VOLUME, 0.8f);
+		hal.setKnob(DspCore::INTERVALS_VOLUME, 0.5f);
+		hal.setKnob(DspCore::ANCHORS_SIZE, 0.5f);
+		hal.setKnob(DspCore::EFFECTS_INTENSITY, 0.5f);
+		hal.setKnob(DspCore::CUTOFF, 0.7f);
+
+		for(int step = 0; step < numSteps; step++){
+			const float time = step * 10.f;
+			const float t = time * 0.001f;
+
+			// triangle sweep over the whole range every 8 s, a slow volume swell on the other hand
+			const float sweep = fabsf(fmodf(t / 4.f, 2.f) - 1.f);
+			hal.setDistances(1050.f - sweep * 900.f, 600.f + 300.f * sinf(t * 0.7f));
+
+			// a different interval every second, the effects come in during the second half of every 8 s
+			const int interval = intervalButtons[static_cast<int>(t) % 5];
+			for(int button = 0; button < DspCore::NUM_BUTTONS; button++){
+				hal.setButton(1, static_cast<DspCore::Button>(button), button == interval);
+			}
+			const bool effects = fmodf(t, 8.f) >= 4.f;
+			hal.setButton(0, DspCore::RIGHT_TOP, effects);
+			hal.setButton(0, DspCore::LEFT_TOP, effects);
+
+			timeline.push_back({time, hal.getControls()});
+		}
+	}
+}
+
+int main(int argc, char** argv){
+	const char* tracePath = nullptr;
+	const char* outputPath = nullptr;
+	const char* dumpPath = nullptr;
+	bool isProfiled = false;
+	float seconds = 0.f;
+	float sampleRate = 48000.f;
+	int blockSize = 48;
+
+	int option;
+	while((option = getopt(argc, argv, "t:s:o:r:b:d:ph")) != -1){
+		switch(option){
+			case 't': tracePath = optarg; break;
+			case 's': seconds = strtof(optarg, nullptr); break;
+			case 'o': outputPath = optarg; break;
+			case 'r': sampleRate = strtof(optarg, nullptr); break;
+			case 'b': blockSize = atoi(optarg); break;
+			case 'd': dumpPath = optarg; break;
+			case 'p': isProfiled = true; break;
+			default: printUsage(argv[0]); return option == 'h' ? 0 : 1;
+		}
+	}
+
+	std::vector<Reading> timeline;
+	if(tracePath){
+		if(!loadTrace(tracePath, timeline)) return 1;
+	}
+	else if(seconds > 0.f){
+		generateTrace(seconds, timeline);
+	}
+	if(timeline.empty() || blockSize <= 0 || sampleRate <= 0.f){
+		printUsage(argv[0]);
+		return 1;
+	}
+	if(dumpPath) saveTrace(dumpPath, timeline);
+
+	WavWriter wav;
+	if(outputPath && !wav.open(outputPath, static_cast<uint32_t>(sampleRate), 2)){
+		fprintf(stderr, "Can't create %s\n", outputPath);
+		return 1;
+	}
+
+	// render the timeline, plus 10 ms after the last reading
+	const double duration = timeline.back().time * 0.001 + 0.01;
+	const size_t numSamples = static_cast<size_t>(duration * sampleRate);
+
+	static DspCore core;
+	static DspCore::Storage storage; // in SDRAM on the firmware
+	std::vector<float> left(blockSize), right(blockSize);
+	float* out[2] = {left.data(), right.data()};
+
+	double renderSeconds = 0.0;
+	const auto initStart = std::chrono::steady_clock::now();
+	core.init(sampleRate, &storage);
+	const double initSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - initStart).count();
+
+	size_t next = 0;
+	for(size_t sample = 0; sample < numSamples; sample += blockSize){
+		const size_t size = numSamples - sample < static_cast<size_t>(blockSize) ? numSamples - sample : blockSize;
+
+		// publish all readings due by the start of this callback
+		const float now = sample * 1000.f / sampleRate;
+		bool changed = false;
+		while(next < timeline.size() && timeline[next].time <= now){
+			next++;
+			changed = true;
+		}
+		if(changed) core.setControls(timeline[next - 1].controls);
+
+		const auto start = std::chrono::steady_clock::now();
+		core.process(out, size);
+		renderSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		if(outputPath) wav.write(out, size);
+
+		// the render runs faster than real time, the loads are relative to the audio it rendered
+		Profiler::Report report;
+		while(isProfiled && core.getProfiler().popReport(report)){
+			char line[160];
+			for(int i = 0; i < Profiler::NUM_LINES; i++){
+				core.getProfiler().format(report, i, line, sizeof(line));
+				printf("%s\n", line);
+			}
+		}
+	}
+	wav.close();
+
+	const double audioSeconds = numSamples / sampleRate;
+	printf("Rendered %.2f s of audio at %.0f Hz in blocks of %d\n", audioSeconds, sampleRate, blockSize);
+	printf("init %.2f ms, render %.2f ms, %.1f x realtime, %.1f ns/sample\n", initSeconds * 1e3, renderSeconds * 1e3,
+		audioSeconds / renderSeconds, renderSeconds * 1e9 / numSamples);
+	return 0;
+}
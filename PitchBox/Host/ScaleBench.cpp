@@ -0,0 +1,109 @@
+#include "Mappings/PitchMap.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+#include <unistd.h>
+
+/*
+Speed of the distance -> note mappings: the original mapping::indexFromDistance(), the Scale engine with the
+chromatic scale and with a scale of uneven zones, and the PitchMap cache in front of it. The distances are random,
+like a hand moving over the whole range, and the anchors size is fixed like when the knob rests.
+
+Also prints how far the chromatic Scale is from indexFromDistance(). The original steps in whole mm and drops back
+a note just before each zone boundary (integer modulo of the 66.7 mm zones), those mm are counted separately.
+*/
+
+namespace {
+	const float ANCHORS_SIZE = 20.f;
+
+	void printUsage(const char* name){
+		fprintf(stderr,
+			"Usage: %s [-n mappings]\n"
+			"  -n  number of mappings per run, default 1000000\n", name);
+	}
+
+	template <typename Function>
+	double nsPerMapping(const std::vector<float>& distances, Function&& function){
+		double best = 1e9;
+		volatile float sink = 0.f;
+		for(int run = 0; run < 5; run++){
+			float sum = 0.f;
+			const auto start = std::chrono::steady_clock::now();
+			for(const float distance: distances) sum += function(distance);
+			const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			sink = sink + sum;
+			if(seconds < best) best = seconds;
+		}
+		return best * 1e9 / distances.size();
+	}
+
+	void compareToOriginal(){
+		Scale scale;
+		float maxDifference = 0.f;
+		int dips = 0;
+		for(int mm = 0; mm < 1200; mm++){
+			const float distance = static_cast<float>(mm);
+			const float difference = fabsf(scale.noteFromDistance(distance, ANCHORS_SIZE) -
+				mapping::indexFromDistance(distance, ANCHORS_SIZE));
+			if(difference > 0.5f) dips++;
+			else maxDifference = fmaxf(maxDifference, difference);
+		}
+		printf("chromatic scale vs original: max difference %.3f notes, %d mm of dips in the original\n",
+			maxDifference, dips);
+	}
+}
+
+int main(int argc, char** argv){
+	int count = 1000000;
+
+	int option;
+	while((option = getopt(argc, argv, "n:h")) != -1){
+		switch(option){
+			case 'n': count = atoi(optarg); break;
+			default: printUsage(argv[0]); return option == 'h' ? 0 : 1;
+		}
+	}
+
+	std::mt19937 random(7);
+	std::uniform_real_distribution<float> uniform(0.f, 1200.f);
+	std::vector<float> distances(count);
+	for(auto& distance: distances) distance = uniform(random);
+
+	Scale chromatic;
+
+	// two octaves of a major scale, the low notes get wider zones
+	float notes[15];
+	float zones[14];
+	for(int i = 0; i < 15; i++){
+		notes[i] = 36.f + 12.f * (i / 7) + mapping::scales::MAJOR[i % 7] - 48.f;
+		if(i < 14) zones[i] = 1.5f - i / 14.f;
+	}
+	Scale major;
+	major.setNotes(notes, 15, 150.f, 1100.f, zones);
+
+	std::unique_ptr<PitchMap> pitchMap(new PitchMap());
+	std::unique_ptr<PitchMap::Tables> pitchTables(new PitchMap::Tables());
+	pitchMap->setTables(pitchTables.get());
+	while(!pitchMap->isReady(ANCHORS_SIZE)) pitchMap->update(ANCHORS_SIZE);
+
+	printf("%-28s %5.2f ns/mapping\n", "indexFromDistance", nsPerMapping(distances, [](const float distance){
+		return mapping::indexFromDistance(distance, ANCHORS_SIZE);
+	}));
+	printf("%-28s %5.2f ns/mapping\n", "scale, chromatic", nsPerMapping(distances, [&chromatic](const float distance){
+		return chromatic.noteFromDistance(distance, ANCHORS_SIZE);
+	}));
+	printf("%-28s %5.2f ns/mapping\n", "scale, 2 octaves uneven", nsPerMapping(distances, [&major](const float distance){
+		return major.noteFromDistance(distance, ANCHORS_SIZE);
+	}));
+	printf("%-28s %5.2f ns/mapping\n", "pitch map (note + loudness)", nsPerMapping(distances, [&pitchMap](const float distance){
+		return pitchMap->lookup(distance, ANCHORS_SIZE).note;
+	}));
+
+	compareToOriginal();
+	return 0;
+}
@@ -0,0 +1,128 @@
+#include "FM/SineKernel.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <unistd.h>
+#include <vector>
+
+/*
+Speed and accuracy of the sine backends of SineKernel.h, every backend with float phases (cycles, wrapped by the
+kernel) and with the 32 bit fixed-point phases of the oscillators:
+	table  1024 point table, linear interpolation
+	poly   9th order polynomial on a quarter wave
+	libm   sinf
+The phases are random and independent, so the throughput isn't limited by the latency of a kernel. The max error is
+measured against the double precision sin over a dense sweep of a whole cycle and printed next to the bound
+documented in SineKernel.h. The bounds are those of the approximations, float rounding adds up to ~1e-7 on top, so
+a backend only fails beyond 1.1 times its bound. Exits with 1 if one does.
+*/
+
+namespace {
+	const int SWEEP_POINTS = 1 << 22;
+
+	void printUsage(const char* name){
+		fprintf(stderr,
+			"Usage: %s [-n calls]\n"
+			"  -n  number of calls per run, default 4000000\n", name);
+	}
+
+	template <typename Phase, typename Function>
+	double nsPerCall(const std::vector<Phase>& phases, const int calls, Function&& function){
+		double best = 1e9;
+		volatile float sink = 0.f;
+		for(int run = 0; run < 5; run++){
+			float sum = 0.f;
+			const auto start = std::chrono::steady_clock::now();
+			for(int done = 0; done < calls; done += static_cast<int>(phases.size())){
+				for(const Phase phase: phases) sum += function(phase);
+			}
+			const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			sink = sink + sum;
+			if(seconds < best) best = seconds;
+		}
+		const int rounded = (calls + static_cast<int>(phases.size()) - 1) / static_cast<int>(phases.size());
+		return best * 1e9 / (static_cast<double>(rounded) * phases.size());
+	}
+
+	/// Max abs error over a whole cycle, float phases slightly outside of [0, 1) to also cover the wrap
+	template <typename Function>
+	double maxErrorOfFloat(Function&& function){
+		double maxError = 0.;
+		for(int i = 0; i < SWEEP_POINTS; i++){
+			const float cycles = -1.f + 3.f * static_cast<float>(i) / SWEEP_POINTS;
+			const double exact = sin(2. * M_PI * static_cast<double>(cycles));
+			maxError = fmax(maxError, fabs(function(cycles) - exact));
+		}
+		return maxError;
+	}
+
+	template <typename Function>
+	double maxErrorOfFixed(Function&& function){
+		double maxError = 0.;
+		for(uint64_t i = 0; i < SWEEP_POINTS; i++){
+			const uint32_t phase = static_cast<uint32_t>((i << 32) / SWEEP_POINTS) + static_cast<uint32_t>(i * 2654435761u % 1024);
+			const double exact = sin(2. * M_PI * phase / 4294967296.);
+			maxError = fmax(maxError, fabs(function(phase) - exact));
+		}
+		return maxError;
+	}
+
+	struct Row {
+		const char* name;
+		double floatNs;
+		double fixedNs;
+		double floatError;
+		double fixedError;
+		double bound;
+	};
+}
+
+int main(int argc, char** argv){
+	int calls = 4000000;
+
+	int option;
+	while((option = getopt(argc, argv, "n:h")) != -1){
+		switch(option){
+			case 'n': calls = atoi(optarg); break;
+			default: printUsage(argv[0]); return option == 'h' ? 0 : 1;
+		}
+	}
+
+	std::mt19937 random(7);
+	std::uniform_real_distribution<float> uniform(0.f, 1.f);
+	std::vector<float> cycles(4096);
+	std::vector<uint32_t> fixed(cycles.size());
+	for(size_t i = 0; i < cycles.size(); i++){
+		cycles[i] = uniform(random);
+		fixed[i] = random();
+	}
+
+	// the bounds documented in SineKernel.h
+	Row rows[] = {
+		{"table", nsPerCall(cycles, calls, [](const float x){ return sine::fromTable(x); }),
+			nsPerCall(fixed, calls, [](const uint32_t x){ return sine::fromTable(x); }),
+			maxErrorOfFloat([](const float x){ return sine::fromTable(x); }),
+			maxErrorOfFixed([](const uint32_t x){ return sine::fromTable(x); }), 4.7e-6},
+		{"poly", nsPerCall(cycles, calls, [](const float x){ return sine::fromPoly(x); }),
+			nsPerCall(fixed, calls, [](const uint32_t x){ return sine::fromPoly(x); }),
+			maxErrorOfFloat([](const float x){ return sine::fromPoly(x); }),
+			maxErrorOfFixed([](const uint32_t x){ return sine::fromPoly(x); }), 3.6e-6},
+		{"libm", nsPerCall(cycles, calls, [](const float x){ return sine::fromLibm(x); }),
+			nsPerCall(fixed, calls, [](const uint32_t x){ return sine::fromLibm(x); }),
+			maxErrorOfFloat([](const float x){ return sine::fromLibm(x); }),
+			maxErrorOfFixed([](const uint32_t x){ return sine::fromLibm(x); }), 6e-7},
+	};
+
+	bool isOk = true;
+	printf("%-6s %10s %10s %12s %12s %10s\n", "", "float ns", "fixed ns", "float error", "fixed error", "bound");
+	for(const auto& row: rows){
+		const bool isWithin = row.floatError <= 1.1 * row.bound && row.fixedError <= 1.1 * row.bound;
+		isOk = isOk && isWithin;
+		printf("%-6s %10.2f %10.2f %12.2e %12.2e %10.1e%s\n", row.name, row.floatNs, row.fixedNs, row.floatError,
+			row.fixedError, row.bound, isWithin ? "" : "  FAILED");
+	}
+	return isOk ? 0 : 1;
+}
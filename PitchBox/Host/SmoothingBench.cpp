@@ -0,0 +1,114 @@
+#include "Mappings/Smoothing.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <initializer_list>
+#include <unistd.h>
+
+/*
+Speed of the Smoothing block kernels against reading the value sample by sample, and a check that both give the
+same ramp. Every block of the run starts a new target, so the kernels are measured while ramping, the expensive case.
+*/
+
+namespace {
+	const float SAMPLE_RATE = 48000.f;
+	const size_t BLOCK_SIZE = 48;
+
+	void printUsage(const char* name){
+		fprintf(stderr,
+			"Usage: %s [-b blocks] [-r rampMs]\n"
+			"  -b  number of blocks per run, default 100000\n"
+			"  -r  ramp time, default 25\n", name);
+	}
+
+	/// Largest difference between the kernels and getNextValue() over a few targets with ramps ending mid-block
+	float compare(const float rampMs, const Smoothing::Mode mode){
+		Smoothing scalar(rampMs, mode), block(rampMs, mode), gain(rampMs, mode);
+		for(auto* smoothing: {&scalar, &block, &gain}) smoothing->setSampleRate(SAMPLE_RATE);
+
+		float values[BLOCK_SIZE], scaled[BLOCK_SIZE];
+		float maxDifference = 0.f;
+		for(int i = 0; i < 200; i++){
+			if(i % 7 == 0){
+				const float target = (i * 37 % 100) * 0.01f;
+				for(auto* smoothing: {&scalar, &block, &gain}) smoothing->setTargetValue(target);
+			}
+
+			block.process(values, BLOCK_SIZE - i % 5);
+			for(size_t j = 0; j < BLOCK_SIZE; j++) scaled[j] = 2.f;
+			gain.applyGain(scaled, BLOCK_SIZE - i % 5);
+
+			for(size_t j = 0; j < BLOCK_SIZE - i % 5; j++){
+				const float expected = scalar.getNextValue();
+				maxDifference = fmaxf(maxDifference, fabsf(values[j] - expected));
+				maxDifference = fmaxf(maxDifference, fabsf(scaled[j] * 0.5f - expected));
+			}
+		}
+		return maxDifference;
+	}
+
+	template <typename Function>
+	double nsPerSample(const int blocks, Function&& function){
+		double best = 1e9;
+		for(int run = 0; run < 5; run++){
+			const auto start = std::chrono::steady_clock::now();
+			for(int i = 0; i < blocks; i++) function(i);
+			const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			if(seconds < best) best = seconds;
+		}
+		return best * 1e9 / (static_cast<double>(blocks) * BLOCK_SIZE);
+	}
+
+	void benchmark(const char* name, const int blocks, const float rampMs, const Smoothing::Mode mode){
+		Smoothing smoothing(rampMs, mode);
+		smoothing.setSampleRate(SAMPLE_RATE);
+
+		float buffer[BLOCK_SIZE];
+		for(auto& sample: buffer) sample = 1.f;
+		volatile float sink = 0.f;
+
+		// a new target every block, alternating so the value keeps moving
+		const auto retarget = [&smoothing](const int i){ smoothing.setTargetValue(i % 2 ? 0.2f : 0.8f); };
+
+		const double scalar = nsPerSample(blocks, [&](const int i){
+			retarget(i);
+			for(size_t j = 0; j < BLOCK_SIZE; j++) buffer[j] *= smoothing.getNextValue();
+			sink = sink + buffer[0];
+			buffer[0] = 1.f;
+		});
+		const double process = nsPerSample(blocks, [&](const int i){
+			retarget(i);
+			smoothing.process(buffer, BLOCK_SIZE);
+			sink = sink + buffer[0];
+		});
+		const double applyGain = nsPerSample(blocks, [&](const int i){
+			retarget(i);
+			smoothing.applyGain(buffer, BLOCK_SIZE);
+			sink = sink + buffer[0];
+			buffer[0] = 1.f;
+		});
+
+		printf("%-12s getNextValue %5.2f ns/sample  process %5.2f ns/sample  applyGain %5.2f ns/sample"
+			"  max difference %.2g\n", name, scalar, process, applyGain, compare(rampMs, mode));
+	}
+}
+
+int main(int argc, char** argv){
+	int blocks = 100000;
+	float rampMs = 25.f;
+
+	int option;
+	while((option = getopt(argc, argv, "b:r:h")) != -1){
+		switch(option){
+			case 'b': blocks = atoi(optarg); break;
+			case 'r': rampMs = strtof(optarg, nullptr); break;
+			default: printUsage(argv[0]); return option == 'h' ? 0 : 1;
+		}
+	}
+
+	benchmark("linear", blocks, rampMs, Smoothing::Mode::LINEAR);
+	benchmark("exponential", blocks, rampMs, Smoothing::Mode::EXPONENTIAL);
+	return 0;
+}
@@ -0,0 +1,162 @@
+#include "FM/SinusoidSynth.h"
+#include "FM/VoiceBank.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <initializer_list>
+#include <memory>
+#include <unistd.h>
+
+/*
+Speed of mixing the main voice and all five interval voices, the case of the instrument with every interval button
+held. Compares the layouts the voices had:
+	heap        one SinusoidSynth per voice behind a unique_ptr, each rendered by its own loop
+	static      the same voices in a static array, intervals from the compile-time harmony:: table
+	voice bank  VoiceBank, all voices in one structure-of-arrays loop four lanes at a time
+Every block sets the pitch like DspCore does, the gliding hand changes it a little every time.
+
+Also the voices' coefficient update on its own, the fm:: table lookup by note against the exact path it replaced
+(powf for the frequency, then logf and the divisions of fm::fromFrequency), with the max error of the table.
+*/
+
+namespace {
+	const float SAMPLE_RATE = 48000.f;
+	const size_t BLOCK_SIZE = 48;
+
+	const harmony::Interval INTERVALS[VoiceBank::NUM_VOICES] = {harmony::UNISON, harmony::FIFTH, harmony::FOURTH,
+		harmony::MAJOR_THIRD, harmony::MINOR_THIRD, harmony::OCTAVE};
+
+	SinusoidSynth staticVoices[VoiceBank::NUM_VOICES];
+	VoiceBank voiceBank;
+
+	void printUsage(const char* name){
+		fprintf(stderr,
+			"Usage: %s [-b blocks]\n"
+			"  -b  number of blocks per run, default 20000, and 100 coefficient updates per block\n", name);
+	}
+
+	float noteOf(const int block){
+		return 48.f + 12.f * static_cast<float>(block % 2000) / 2000.f;
+	}
+
+	template <typename Function>
+	double nsPerSample(const int blocks, Function&& function){
+		float out[BLOCK_SIZE] = {};
+		double best = 1e9;
+		for(int run = 0; run < 5; run++){
+			const auto start = std::chrono::steady_clock::now();
+			for(int block = 0; block < blocks; block++){
+				for(auto& sample: out) sample = 0.f;
+				function(block, out);
+			}
+			const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			if(seconds < best) best = seconds;
+		}
+
+		volatile float sink = out[0];
+		(void)sink;
+		return best * 1e9 / (static_cast<double>(blocks) * BLOCK_SIZE);
+	}
+
+	/// Random notes over the table's range
+	template <typename Function>
+	double nsPerUpdate(const int count, Function&& function){
+		double best = 1e9;
+		volatile float sink = 0.f;
+		for(int run = 0; run < 5; run++){
+			float sum = 0.f;
+			uint32_t seed = 7;
+			const auto start = std::chrono::steady_clock::now();
+			for(int i = 0; i < count; i++){
+				seed = seed * 1664525u + 1013904223u;
+				const float note = fm::MIN_NOTE + (fm::MAX_NOTE - fm::MIN_NOTE) * static_cast<float>(seed >> 8) * (1.f / (1u << 24));
+				const auto coefficients = function(note);
+				sum += coefficients.frequency + coefficients.I1 + coefficients.I2;
+			}
+			const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			sink = sink + sum;
+			if(seconds < best) best = seconds;
+		}
+		return best * 1e9 / count;
+	}
+
+	/// Max relative error of the frequency and max abs errors of I1 and I2 (cycles) of the table
+	void printTableError(){
+		float frequency = 0.f, i1 = 0.f, i2 = 0.f;
+		for(float note = fm::MIN_NOTE; note < fm::MAX_NOTE; note += 0.001f){
+			const auto table = fm::fromNote(note);
+			const auto exact = fm::fromFrequency(fm::frequencyFromNote(note));
+			frequency = fmaxf(frequency, fabsf(table.frequency / exact.frequency - 1.f));
+			i1 = fmaxf(i1, fabsf(table.I1 - exact.I1));
+			i2 = fmaxf(i2, fabsf(table.I2 - exact.I2));
+		}
+		printf("table error: frequency %.1e relative, I1 %.1e, I2 %.1e cycles\n", frequency, i1, i2);
+	}
+}
+
+int main(int argc, char** argv){
+	int blocks = 20000;
+
+	int option;
+	while((option = getopt(argc, argv, "b:h")) != -1){
+		switch(option){
+			case 'b': blocks = atoi(optarg); break;
+			default: printUsage(argv[0]); return option == 'h' ? 0 : 1;
+		}
+	}
+
+	std::unique_ptr<SinusoidSynth> heapVoices[VoiceBank::NUM_VOICES];
+	for(int voice = 0; voice < VoiceBank::NUM_VOICES; voice++){
+		heapVoices[voice].reset(new SinusoidSynth(INTERVALS[voice]));
+		staticVoices[voice] = SinusoidSynth(INTERVALS[voice]);
+
+		for(auto* synth: {heapVoices[voice].get(), &staticVoices[voice]}){
+			synth->setSampleRate(SAMPLE_RATE);
+			synth->setCarrierNote(noteOf(0));
+			synth->startAttackPhase();
+		}
+
+		const auto id = static_cast<VoiceBank::Voice>(voice);
+		voiceBank.setGain(id, 0.5f);
+		if(id != VoiceBank::MAIN) voiceBank.startAttackPhase(id);
+	}
+	voiceBank.setSampleRate(SAMPLE_RATE);
+
+	const double heap = nsPerSample(blocks, [&heapVoices](const int block, float* out){
+		for(auto& synth: heapVoices){
+			synth->setCarrierNote(noteOf(block));
+			synth->process(out, BLOCK_SIZE, 0.5f);
+		}
+	});
+	const double statics = nsPerSample(blocks, [](const int block, float* out){
+		for(auto& synth: staticVoices){
+			synth.setCarrierNote(noteOf(block));
+			synth.process(out, BLOCK_SIZE, 0.5f);
+		}
+	});
+	const double bank = nsPerSample(blocks, [](const int block, float* out){
+		for(int voice = 0; voice < VoiceBank::NUM_VOICES; voice++){
+			voiceBank.setCarrierNote(static_cast<VoiceBank::Voice>(voice), noteOf(block));
+		}
+		voiceBank.process(out, BLOCK_SIZE);
+	});
+
+	printf("6 voices, %zu-sample blocks\n", BLOCK_SIZE);
+	printf("%-12s %6.2f ns/sample\n", "heap", heap);
+	printf("%-12s %6.2f ns/sample\n", "static", statics);
+	printf("%-12s %6.2f ns/sample\n", "voice bank", bank);
+
+	const int updates = blocks * 100;
+	const double exact = nsPerUpdate(updates, [](const float note){
+		return fm::fromFrequency(fm::frequencyFromNote(note));
+	});
+	const double table = nsPerUpdate(updates, [](const float note){ return fm::fromNote(note); });
+
+	printf("coefficients of a note\n");
+	printf("%-12s %6.2f ns/update\n", "exact", exact);
+	printf("%-12s %6.2f ns/update\n", "table", table);
+	printTableError();
+	return 0;
+}
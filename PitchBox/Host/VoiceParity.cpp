@@ -0,0 +1,139 @@
+#include "FM/SinusoidSynth.h"
+#include "FM/VoiceBank.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+/*
+Parity of the VoiceBank with the scalar reference voice: the bank and six SinusoidSynth voices, one per interval,
+get the same notes, gains and envelopes and their mixes are compared sample by sample. The performance glides the
+note and jumps it now and then, and every interval voice is turned on and off on its own period with its own attack
+and decay times, so the voices wake up, fade in, sustain, fade out and go idle many times.
+
+Both sides use the sine backend the build selects (SINE_BACKEND). The mixes differ by the order of the additions
+only, the bank sums four lanes at a time. Exits with 1 if they differ by more than TOLERANCE anywhere.
+*/
+
+namespace {
+	const float SAMPLE_RATE = 48000.f;
+	const size_t BLOCK_SIZE = 48;
+
+	/// Max abs difference of the mixes. The mix of all six voices peaks at about 3, where a float ULP is 2.4e-7, and
+	/// reordering the six additions moves it by a few ULPs (4.8e-7 measured with every backend). 1e-5 leaves room
+	/// for compilers and flags, a wrong lane, envelope step or gain is orders of magnitude above it
+	const float TOLERANCE = 1e-5f;
+
+	const harmony::Interval INTERVALS[VoiceBank::NUM_VOICES] = {harmony::UNISON, harmony::FIFTH, harmony::FOURTH,
+		harmony::MAJOR_THIRD, harmony::MINOR_THIRD, harmony::OCTAVE};
+
+	void printUsage(const char* name){
+		fprintf(stderr,
+			"Usage: %s [-b blocks]\n"
+			"  -b  number of blocks to compare, default 4000\n", name);
+	}
+
+	const char* backendName(){
+	#if SINE_BACKEND == SINE_BACKEND_POLY
+		return "poly";
+	#elif SINE_BACKEND == SINE_BACKEND_LIBM
+		return "libm";
+	#else
+		return "table";
+	#endif
+	}
+
+	/// Gliding over the main range, jumping up a fourth for a while every 500 blocks
+	float noteOf(const int block){
+		const float glide = 54.f + 6.f * sinf(0.01f * static_cast<float>(block));
+		return block % 500 < 100 ? glide + 5.f : glide;
+	}
+
+	/// Interval voices are on for half of their period, which differs per voice
+	bool isOn(const int voice, const int block){
+		const int period = 150 + 40 * voice;
+		return (block + 37 * voice) % period < period / 2;
+	}
+
+	float attackOf(const int voice) { return 5.f + 3.f * voice; }
+	float decayOf(const int voice) { return 20.f - 3.f * voice; }
+
+	float gainOf(const int voice, const int block){
+		if(voice == VoiceBank::MAIN) return 0.8f + 0.2f * sinf(0.003f * static_cast<float>(block));
+		return 0.5f;
+	}
+}
+
+int main(int argc, char** argv){
+	int blocks = 4000;
+
+	int option;
+	while((option = getopt(argc, argv, "b:h")) != -1){
+		switch(option){
+			case 'b': blocks = atoi(optarg); break;
+			default: printUsage(argv[0]); return option == 'h' ? 0 : 1;
+		}
+	}
+
+	static VoiceBank bank;
+	static SinusoidSynth synths[VoiceBank::NUM_VOICES];
+	bank.setSampleRate(SAMPLE_RATE);
+	for(int voice = 0; voice < VoiceBank::NUM_VOICES; voice++){
+		synths[voice] = SinusoidSynth(INTERVALS[voice]);
+		synths[voice].setSampleRate(SAMPLE_RATE);
+	}
+
+	// the interval voices of the bank start idle, a SinusoidSynth starts sustaining: fade the synths out first
+	float scratch[BLOCK_SIZE];
+	for(int voice = 1; voice < VoiceBank::NUM_VOICES; voice++){
+		synths[voice].startDecayPhase(1.f);
+		while(!synths[voice].isSilent()) synths[voice].process(scratch, BLOCK_SIZE, 0.f);
+	}
+
+	bool wasOn[VoiceBank::NUM_VOICES] = {true};
+	float maxDifference = 0.f;
+	float peak = 0.f;
+	int worstBlock = 0;
+	int attacks = 0;
+	for(int block = 0; block < blocks; block++){
+		float bankOut[BLOCK_SIZE] = {};
+		float synthOut[BLOCK_SIZE] = {};
+
+		for(int voice = 0; voice < VoiceBank::NUM_VOICES; voice++){
+			const auto id = static_cast<VoiceBank::Voice>(voice);
+			if(voice != VoiceBank::MAIN && isOn(voice, block) != wasOn[voice]){
+				wasOn[voice] = !wasOn[voice];
+				if(wasOn[voice]){
+					bank.startAttackPhase(id, attackOf(voice));
+					synths[voice].startAttackPhase(attackOf(voice));
+					attacks++;
+				}
+				else {
+					bank.startDecayPhase(id, decayOf(voice));
+					synths[voice].startDecayPhase(decayOf(voice));
+				}
+			}
+
+			bank.setCarrierNote(id, noteOf(block));
+			bank.setGain(id, gainOf(voice, block));
+			synths[voice].setCarrierNote(noteOf(block));
+			synths[voice].process(synthOut, BLOCK_SIZE, gainOf(voice, block));
+		}
+		bank.process(bankOut, BLOCK_SIZE);
+
+		for(size_t i = 0; i < BLOCK_SIZE; i++){
+			const float difference = fabsf(bankOut[i] - synthOut[i]);
+			if(difference > maxDifference){
+				maxDifference = difference;
+				worstBlock = block;
+			}
+			peak = fmaxf(peak, fabsf(synthOut[i]));
+		}
+	}
+
+	const bool isOk = maxDifference <= TOLERANCE;
+	printf("%s backend, %d blocks, %d attacks: max difference %.2e (block %d) on a %.2f peak, tolerance %.0e %s\n",
+		backendName(), blocks, attacks, maxDifference, worstBlock, peak, TOLERANCE, isOk ? "passed" : "FAILED");
+	return isOk ? 0 : 1;
+}
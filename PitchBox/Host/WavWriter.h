@@ -0,0 +1,87 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+/// @brief Minimal writer of 32-bit float WAV files. The header is written on open() and its sizes are patched
+/// on close(). Assumes a little-endian host.
+class WavWriter {
+public:
+	WavWriter() = default;
+	~WavWriter() { close(); }
+
+	/// @brief Creates the file and writes a header for given format
+	/// @return false if the file can't be created
+	bool open(const char* path, const uint32_t sampleRate, const uint16_t numChannels){
+		file = fopen(path, "wb");
+		if(!file) return false;
+
+		channels = numChannels;
+		frames = 0;
+
+		const uint16_t format = 3; // WAVE_FORMAT_IEEE_FLOAT
+		const uint16_t bitsPerSample = 32;
+		const uint16_t blockAlign = channels * bitsPerSample / 8;
+		const uint32_t byteRate = sampleRate * blockAlign;
+
+		fwrite("RIFF", 1, 4, file);
+		write32(0); // patched on close
+		fwrite("WAVE", 1, 4, file);
+
+		fwrite("fmt ", 1, 4, file);
+		write32(18);
+		write16(format);
+		write16(channels);
+		write32(sampleRate);
+		write32(byteRate);
+		write16(blockAlign);
+		write16(bitsPerSample);
+		write16(0); // no extension
+
+		fwrite("fact", 1, 4, file);
+		write32(4);
+		write32(0); // patched on close
+
+		fwrite("data", 1, 4, file);
+		write32(0); // patched on close
+		return true;
+	}
+
+	/// @brief Writes n frames from separate channel buffers
+	void write(const float* const* channelData, const size_t n){
+		interleaved.resize(n * channels);
+		for(size_t i = 0; i < n; i++){
+			for(uint16_t c = 0; c < channels; c++) interleaved[i * channels + c] = channelData[c][i];
+		}
+		fwrite(interleaved.data(), sizeof(float), interleaved.size(), file);
+		frames += n;
+	}
+
+	/// @brief Patches the header sizes and closes the file
+	void close(){
+		if(!file) return;
+
+		const uint32_t dataSize = static_cast<uint32_t>(frames * channels * sizeof(float));
+		fseek(file, 4, SEEK_SET);
+		write32(HEADER_SIZE - 8 + dataSize);
+		fseek(file, FACT_OFFSET, SEEK_SET);
+		write32(static_cast<uint32_t>(frames));
+		fseek(file, HEADER_SIZE - 4, SEEK_SET);
+		write32(dataSize);
+
+		fclose(file);
+		file = nullptr;
+	}
+
+private:
+	static const long FACT_OFFSET = 12 + 8 + 18 + 8; // RIFF header, fmt chunk, fact chunk header
+	static const long HEADER_SIZE = FACT_OFFSET + 4 + 8;
+
+	void write16(const uint16_t value) { fwrite(&value, sizeof(value), 1, file); }
+	void write32(const uint32_t value) { fwrite(&value, sizeof(value), 1, file); }
+
+	FILE* file{nullptr};
+	uint16_t channels{0};
+	size_t frames{0};
+	std::vector<float> interleaved;
+};
@@ -0,0 +1,149 @@
+#include "DspCore.h"
+
+#include "../FM/FmCoefficients.h"
+#include "../Mappings/SonicSensor.h"
+#include "../Mappings/Knobs.h"
+
+#include <algorithm>
+#include <initializer_list>
+
+DspCore::DspCore(){
+	// effectsIntensity acts as a dry/wet of the overdrive and the chorus, the low pass is always on. The chorus makes
+	// the stereo image, so it comes last
+	effects.addStage(overdrive, EffectChain::Blend::MIXED);
+	effects.addStage(lowPass, EffectChain::Blend::WET, true);
+	effects.addStage(chorus, EffectChain::Blend::MIXED);
+}
+
+void DspCore::init(const float sampleRate, Storage* storage){
+	this->sampleRate = sampleRate;
+	pitchMap.setTables(storage ? &storage->pitchTables : nullptr);
+	chorus.setLine(storage ? &storage->chorusLine : nullptr);
+
+	for(auto* smoothing: {&masterVolumeSmoothing, &intervalsVolumeSmoothing, &anchorsSizeSmoothing, &pitchDistanceSmoothing,
+		&volumeDistanceSmoothing, &outputGainSmoothing}){
+		smoothing->setSampleRate(sampleRate);
+	}
+
+	voices.setSampleRate(sampleRate);
+	voices.setGain(VoiceBank::MAIN, 1.f);
+
+	effects.init(sampleRate);
+	profiler.init(sampleRate);
+}
+
+bool DspCore::scheduleControls(const Controls& newControls, const uint32_t time){
+	if(controlEvents.push({time, newControls})) return true;
+
+	droppedControls++;
+	return false;
+}
+
+void DspCore::receiveControls(){
+	const uint32_t blockStart = getSampleTime();
+
+	ControlEvent event;
+	bool isNew = false;
+	while(const auto* next = controlEvents.peek()){
+		if(static_cast<int32_t>(next->sampleTime - blockStart) > 0) break; // not due yet, later ones aren't either
+		controlEvents.pop(event);
+		isNew = true;
+	}
+
+	// snapshots hold the whole state, only the newest one matters
+	if(isNew) applyControls(event.controls);
+}
+
+void DspCore::applyControls(const Controls& newControls){
+	controls = newControls;
+
+	// Timeouts are reported as negative distances, treat them as the closest position
+	pitchDistanceSmoothing.setTargetValue(controls.distancePitch < 0.f ? 0.f : controls.distancePitch);
+	volumeDistanceSmoothing.setTargetValue(controls.distanceVolume < 0.f ? 0.f : controls.distanceVolume);
+
+	// Update each smoothing's target value to the new knob readings
+	masterVolumeSmoothing.setTargetValue(isEffectPressed(LEFT_MIDDLE) ? 0.f : controls.knobs[MASTER_VOLUME]);
+	intervalsVolumeSmoothing.setTargetValue(mapping::intervalVolumeScaled(controls.knobs[INTERVALS_VOLUME]));
+	anchorsSizeSmoothing.setTargetValue(mapping::anchorsSizeScaled(controls.knobs[ANCHORS_SIZE]));
+	effects.setWet(mapping::effectsInternsityScaled(controls.knobs[EFFECTS_INTENSITY]));
+	lowPass.setCutoff(mapping::cutoffScaled(controls.knobs[CUTOFF]));
+
+	// Effects are faded in and out when their buttons change
+	effects.setEnabled(OVERDRIVE, isEffectPressed(RIGHT_TOP));
+	effects.setEnabled(CHORUS, isEffectPressed(LEFT_TOP));
+}
+
+void DspCore::prepareSideSynth(const VoiceBank::Voice voice, bool& prevState, const bool newState, const float gain){
+	// if the synth was just turned on/off reset it
+	if(prevState != newState){
+		prevState = newState;
+
+		if(newState) voices.startAttackPhase(voice);
+		else voices.startDecayPhase(voice);
+	}
+
+	// the main voice's compensation is part of the output gain, the interval's own replaces it
+	voices.setGain(voice, gain * mapping::equalLoudnessFromNote(curNote + VoiceBank::getHarmony(voice).semitones) / curLoudness);
+
+	if(!newState) return; // synth is turned off, nothing to do
+
+	// if the synth is turned on, update pitch
+	voices.setCarrierNote(voice, curNote);
+}
+
+void DspCore::process(float* const* out, const size_t size){
+	profiler.start();
+	receiveControls();
+
+	// Get and/or calculate values for processing, the pitch and the voices are updated once per callback
+	curPitchDistance = pitchDistanceSmoothing.advance(size);
+	const auto anchorsSize = anchorsSizeSmoothing.advance(size);
+	pitchMap.update(anchorsSize);
+	const auto mapped = pitchMap.lookup(curPitchDistance, anchorsSize);
+	curNote = mapped.note;
+	curPitch = fm::fromNote(curNote).frequency; // same as mapping::pitchFromDistance, without the powf
+	if(!isEffectPressed(BOTTOM)) { // If not in the Sustain Mode, update curVolume value
+		curVolume = mapping::gainFromDistance(volumeDistanceSmoothing.advance(size));
+	}
+
+	curLoudness = mapped.loudness;
+	outputGainSmoothing.setTargetValue(curVolume * curLoudness); // ramped over the callback
+	const auto intervalsVolume = intervalsVolumeSmoothing.advance(size);
+
+	voices.setCarrierNote(VoiceBank::MAIN, curNote); // update pitch of the main synth
+
+	// prapare all interval synths, they are mixed scaled by the intervals volume
+	prepareSideSynth(VoiceBank::FIFTH, isFifthOn, isIntervalPressed(LEFT_MIDDLE), intervalsVolume);
+	prepareSideSynth(VoiceBank::FOURTH, isFourthOn, isIntervalPressed(RIGHT_MIDDLE), intervalsVolume);
+	prepareSideSynth(VoiceBank::THIRD, isThirdOn, isIntervalPressed(LEFT_TOP), intervalsVolume);
+	prepareSideSynth(VoiceBank::THIRD_MINOR, isThirdMinorOn, isIntervalPressed(RIGHT_TOP), intervalsVolume);
+	prepareSideSynth(VoiceBank::OCTAVE, isOctaveOn, isIntervalPressed(BOTTOM), intervalsVolume);
+	profiler.lap(Profiler::MAPPING);
+
+	for(size_t offset = 0; offset < size; offset += MAX_BLOCK_SIZE) {
+		const size_t blockSize = size - offset < MAX_BLOCK_SIZE ? size - offset : MAX_BLOCK_SIZE;
+
+		// render all synths into the mix buffer
+		std::fill(mixBuffer, mixBuffer + blockSize, 0.f);
+		voices.process(mixBuffer, blockSize);
+		profiler.lap(Profiler::VOICES);
+
+		// overdrive, the low pass and the chorus, which splits the mix into left and right
+		effects.process(mixBuffer, rightBuffer, blockSize);
+		profiler.lap(Profiler::EFFECTS);
+
+		// Gain, ramped per sample, the same for both channels
+		outputGainSmoothing.process(gainBuffer, blockSize);
+		masterVolumeSmoothing.applyGain(gainBuffer, blockSize);
+
+		// write the result to output buffer
+		for(size_t i = 0; i < blockSize; i++){
+			out[0][offset + i] = mixBuffer[i] * gainBuffer[i];
+			out[1][offset + i] = rightBuffer[i] * gainBuffer[i];
+		}
+		profiler.lap(Profiler::OUTPUT);
+	}
+
+	sampleTime.store(getSampleTime() + size, std::memory_order_release);
+	profiler.stop(size);
+}
@@ -0,0 +1,208 @@
+#pragma once
+#include "daisysp.h"
+
+#include "../Effects/Chorus.h"
+#include "../Effects/EffectChain.h"
+#include "../Effects/LowPass.h"
+#include "../Effects/OversampledOverdrive.h"
+#include "../FM/VoiceBank.h"
+#include "../FM/WavetableSynth.h"
+#include "../Mappings/PitchMap.h"
+#include "../Mappings/Smoothing.h"
+#include "Profiler.h"
+#include "SpscQueue.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/// @brief Everything PitchBox does with sound, without any hardware: the voices, the mappings, the smoothing and
+/// the effects. The firmware feeds it the readings of the buttons, knobs and ultrasonic sensors and calls
+/// process() from the audio callback. The host build feeds it the same Controls from a mock HAL.
+///
+/// The control loop and the audio callback share nothing but a lock-free queue: setControls() publishes a snapshot
+/// of all controls, process() takes the newest due snapshot at the start of a block and updates the smoothing
+/// targets from it. Everything else is only touched by the audio side.
+class DspCore {
+public:
+	/// Buttons of one handle. Their meaning depends on the hand, see Controls
+	enum Button {
+		LEFT_TOP = 0,	// third mj / chorus
+		RIGHT_TOP,		// third min / overdrive
+		LEFT_MIDDLE,	// fifth / mute
+		RIGHT_MIDDLE,	// forth / nothing
+		BOTTOM,			// octave / sustain
+		NUM_BUTTONS
+	};
+
+	/// Knobs
+	enum Knob {
+		MASTER_VOLUME = 0,
+		INTERVALS_VOLUME,
+		ANCHORS_SIZE,
+		EFFECTS_INTENSITY,
+		CUTOFF,
+		NUM_KNOBS
+	};
+
+	/// @brief One reading of all the controls of the instrument
+	struct Controls {
+		float distancePitch{0.f};	// mm, negative when the sensor timed out
+		float distanceVolume{0.f};	// mm, negative when the sensor timed out
+		float knobs[NUM_KNOBS]{};	// raw readings, 0 - 1
+		uint16_t buttons{0};		// one bit per button, see buttonBit()
+		bool isLeftRight{false};	// handle [isLeftRight] holds the effect buttons, [!isLeftRight] the intervals
+
+		/// @brief Bit of a button of given handle (0 or 1) in the buttons mask
+		static uint16_t buttonBit(const int handle, const Button button) { return 1u << (handle * NUM_BUTTONS + button); }
+
+		bool isPressed(const int handle, const Button button) const { return (buttons & buttonBit(handle, button)) != 0; }
+		void setPressed(const int handle, const Button button, const bool pressed){
+			if(pressed) buttons |= buttonBit(handle, button);
+			else buttons &= ~buttonBit(handle, button);
+		}
+	};
+
+	/// @brief A snapshot of the controls and the time it should take effect
+	struct ControlEvent {
+		uint32_t sampleTime;	// see getSampleTime()
+		Controls controls;
+	};
+
+	/// Stages of the effect chain, in the order they run
+	enum Effect {
+		OVERDRIVE = 0,
+		LOW_PASS,
+		CHORUS,	// last, it's stereo
+		NUM_EFFECTS
+	};
+
+	/// Voices are rendered block-wise, longer callbacks are processed in chunks of this size
+	static const size_t MAX_BLOCK_SIZE = EffectChain::MAX_BLOCK_SIZE;
+
+	/// Snapshots waiting for the audio callback. The audio side drains it every block, so a few are plenty
+	static const size_t CONTROL_QUEUE_SIZE = 8;
+
+	/// @brief The large, sparsely accessed state, kept outside of the core so the firmware can place it in SDRAM
+	struct Storage {
+		PitchMap::Tables pitchTables;	// see PitchMap
+		ChorusStage::Line chorusLine;
+	};
+
+	DspCore();
+	~DspCore() = default;
+
+	/// @brief Prepares the voices and the effects. Has to be called before process()
+	/// @param sampleRate The audio sample rate
+	/// @param storage Without it the pitch is mapped directly and the chorus does nothing
+	void init(const float sampleRate, Storage* storage = nullptr);
+
+	/// @brief Publishes new readings of the controls, the audio callback picks them up at the start of its next
+	/// block. Meant to be called from the control loop, the only producer.
+	/// @return false if the queue was full. Snapshots hold the state of all controls, so a dropped one is simply
+	/// superseded by the next call.
+	bool setControls(const Controls& newControls) { return scheduleControls(newControls, getSampleTime()); }
+
+	/// @brief Same as setControls, the snapshot takes effect at the start of the first block which begins at or
+	/// after given sample time. Snapshots are taken in order, so the sample times must not decrease from call to call.
+	bool scheduleControls(const Controls& newControls, const uint32_t sampleTime);
+
+	/// @brief Number of samples rendered so far, the clock of the control events. Wraps around.
+	uint32_t getSampleTime() const { return sampleTime.load(std::memory_order_acquire); }
+
+	/// @brief The snapshot the current block was rendered with. Audio side only, e.g. from the audio callback.
+	const Controls& getControls() const { return controls; }
+
+	/// @brief Snapshots which didn't fit into the queue so far
+	uint32_t getDroppedControls() const { return droppedControls; }
+
+	/// @brief Renders one audio block. Meant to be called from the audio callback.
+	/// @param out Two output channels of size samples, left and right
+	/// @param size Number of samples
+	void process(float* const* out, const size_t size);
+
+	/// @brief Replaces the scale the pitch hand plays, chromatic by default. Not synchronised with process(), call it
+	/// before the audio starts or while it's stopped
+	void setScale(const Scale& scale) { pitchMap.setScale(scale); }
+
+	/// @brief Sets the oversampling of the overdrive, 1, 2 or 4, at most OVERDRIVE_OVERSAMPLING which is the default.
+	/// Not synchronised with process() either
+	void setOversampling(const int factor) { overdrive.setFactor(factor); }
+
+	/// @brief Sets the low pass behind the cutoff knob, the one-pole by default or the SVF with given resonance (Q).
+	/// Not synchronised with process() either
+	void setLowPass(const LowPassStage::Mode mode, const float resonance = 0.707f){
+		lowPass.setMode(mode);
+		lowPass.setResonance(resonance);
+	}
+
+	/// @brief Times of the callbacks and their sections. Control side only pops and formats its reports
+	Profiler& getProfiler() { return profiler; }
+
+	/// @brief Currently played pitch in Hz
+	float getPitch() const { return curPitch; }
+
+	/// @brief Smoothed pitch hand distance in mm the current pitch was mapped from
+	float getPitchDistance() const { return curPitchDistance; }
+
+private:
+	/// Takes the newest snapshot due at the start of the coming block and updates the smoothing targets from it
+	void receiveControls();
+	void applyControls(const Controls& newControls);
+
+	/// Updates the interval synths' states. Turns them on and off depending on the current and previous states and initializes the attack and decay phases accordingly.
+	void prepareSideSynth(const VoiceBank::Voice voice, bool& prevState, const bool newState, const float gain);
+
+	bool isEffectPressed(const Button button) const { return controls.isPressed(controls.isLeftRight, button); }
+	bool isIntervalPressed(const Button button) const { return controls.isPressed(!controls.isLeftRight, button); }
+
+	float sampleRate{48000.f};
+	Controls controls; // audio side copy
+
+	SpscQueue<ControlEvent, CONTROL_QUEUE_SIZE> controlEvents;
+	Profiler profiler;
+	std::atomic<uint32_t> sampleTime{0};
+	uint32_t droppedControls{0}; // control side
+
+	// Ramp times match the previous 25 steps of one per 1 ms callback
+	Smoothing masterVolumeSmoothing{25.f};
+	Smoothing intervalsVolumeSmoothing{25.f};
+	Smoothing anchorsSizeSmoothing{25.f};
+
+	Smoothing pitchDistanceSmoothing{25.f};
+	Smoothing volumeDistanceSmoothing{25.f};
+
+	/// Interpolates the volume computed once per callback over the samples of the callback
+	Smoothing outputGainSmoothing{1.f};
+
+	// Main synth and all interval synths (fifth, fourth, third, minor third, octave)
+#ifdef WAVETABLE_ENGINE
+	WavetableBank voices;
+#else
+	VoiceBank voices;
+#endif
+
+	bool isFifthOn{false};
+	bool isFourthOn{false};
+	bool isThirdOn{false};
+	bool isThirdMinorOn{false};
+	bool isOctaveOn{false};
+
+	PitchMap pitchMap;
+
+	float mixBuffer[MAX_BLOCK_SIZE];	// left channel after the effects
+	float rightBuffer[MAX_BLOCK_SIZE];
+	float gainBuffer[MAX_BLOCK_SIZE];
+
+	float curPitchDistance{0.f};
+	float curNote{0.f};
+	float curPitch{0.f};
+	float curVolume{1.f};
+	float curLoudness{1.f}; // equal loudness gain of the main voice
+
+	// Completely random effects, see Effect for their order
+	OversampledOverdriveStage overdrive;
+	ChorusStage chorus;
+	LowPassStage lowPass;
+	EffectChain effects;
+};
@@ -0,0 +1,20 @@
+#pragma once
+
+/// @brief Placement of statically allocated state in the memories of the STM32H750. Nothing is allocated at run time,
+/// everything lives in one of these (or in the default .bss in AXI SRAM):
+///
+/// PITCHBOX_DTCM	128 KB tightly coupled to the core, no wait states and no cache. For what the audio callback
+/// 				touches every sample. Not zeroed at start up, objects placed here need constructors which
+/// 				initialise all of their members.
+/// PITCHBOX_SDRAM	64 MB external, through the data cache. For large buffers read sparsely. Only usable after
+/// 				DaisySeed::Init(), so objects placed here must not have constructors.
+///
+/// The names are the sections of libDaisy's linker script (DTCM_MEM_SECTION and DSY_SDRAM_BSS). On the host, and
+/// on any other target, both expand to nothing.
+#if defined(STM32H750xx)
+#define PITCHBOX_DTCM __attribute__((section(".dtcmram_bss")))
+#define PITCHBOX_SDRAM __attribute__((section(".sdram_bss")))
+#else
+#define PITCHBOX_DTCM
+#define PITCHBOX_SDRAM
+#endif
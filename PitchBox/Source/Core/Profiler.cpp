@@ -0,0 +1,110 @@
+#include "Profiler.h"
+
+#include <cstdio>
+
+namespace {
+	const char* const SECTION_NAMES[Profiler::NUM_SECTIONS] = {"mapping", "voices", "effects", "output"};
+
+	/// Appends to text, keeps the offset within size like snprintf() does
+	template <typename... Args>
+	void append(char* text, const size_t size, size_t& offset, const char* format, Args... args){
+		if(offset >= size) return;
+		const int written = snprintf(text + offset, size - offset, format, args...);
+		if(written > 0) offset += static_cast<size_t>(written);
+	}
+}
+
+void Profiler::init(const float sampleRate){
+#if defined(STM32H750xx)
+	// the cycle counter of the debug unit, it only counts while trace is enabled
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->LAR = 0xC5ACCE55; // unlocks the DWT registers of the Cortex-M7
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	ticksPerSecond = static_cast<float>(SystemCoreClock);
+#else
+	ticksPerSecond = 1e9f;
+#endif
+
+	ticksPerSample = ticksPerSecond / sampleRate;
+	reportSamples = static_cast<uint32_t>(REPORT_SECONDS * sampleRate);
+	totalOverruns = 0;
+	reset();
+}
+
+void Profiler::stop(const size_t size){
+	const uint32_t ticks = now() - startTime;
+	const uint32_t deadline = static_cast<uint32_t>(static_cast<float>(size) * ticksPerSample);
+
+	current.callbacks++;
+	current.samples += static_cast<uint32_t>(size);
+	add(current.callback, ticks);
+	for(int section = 0; section < NUM_SECTIONS; section++) add(current.sections[section], sectionTicks[section]);
+
+	// per mille of the deadline, 64 bits so a stalled callback doesn't overflow it
+	const uint64_t load = deadline > 0 ? static_cast<uint64_t>(ticks) * 1000 / deadline : 0;
+	if(load > current.peakLoad) current.peakLoad = static_cast<uint32_t>(load);
+	if(ticks > deadline){
+		current.histogram[NUM_BINS - 1]++;
+		totalOverruns++;
+	}
+	else current.histogram[load >= 1000 ? NUM_BINS - 2 : load / 100]++;
+
+	if(current.samples < reportSamples) return;
+
+	// a report the control side didn't pick up yet is kept, this one is dropped
+	current.totalOverruns = totalOverruns;
+	reports.push(current);
+	reset();
+}
+
+void Profiler::format(const Report& report, const int line, char* text, const size_t size) const {
+	if(size == 0) return;
+	text[0] = '\0';
+	if(report.callbacks == 0) return;
+
+	const float usPerTick = 1e6f / ticksPerSecond;
+	const auto us = [usPerTick](const uint64_t ticks) { return static_cast<unsigned>(static_cast<float>(ticks) * usPerTick + 0.5f); };
+	const auto average = [&report](const Timing& timing) { return timing.sum / report.callbacks; };
+
+	size_t offset = 0;
+	switch(line){
+		case 0: {
+			// the average load is the time of all callbacks over all their deadlines
+			const float deadlines = static_cast<float>(report.samples) * ticksPerSample;
+			append(text, size, offset, "%u callbacks, us min/avg/max %u/%u/%u, load avg %u%% peak %u%%, overruns %u (%u total)",
+				static_cast<unsigned>(report.callbacks), us(report.callback.min), us(average(report.callback)),
+				us(report.callback.max), static_cast<unsigned>(100.f * static_cast<float>(report.callback.sum) / deadlines + 0.5f),
+				static_cast<unsigned>((report.peakLoad + 5) / 10), static_cast<unsigned>(report.histogram[NUM_BINS - 1]),
+				static_cast<unsigned>(report.totalOverruns));
+			break;
+		}
+		case 1:
+			append(text, size, offset, "us min/avg/max");
+			for(int section = 0; section < NUM_SECTIONS; section++){
+				const auto& timing = report.sections[section];
+				append(text, size, offset, "%s%s %u/%u/%u", section == 0 ? " " : ", ", SECTION_NAMES[section], us(timing.min),
+					us(average(timing)), us(timing.max));
+			}
+			break;
+		case 2:
+			append(text, size, offset, "load 0-100%% by 10%%:");
+			for(int bin = 0; bin < NUM_BINS - 1; bin++) append(text, size, offset, " %u", static_cast<unsigned>(report.histogram[bin]));
+			append(text, size, offset, ", over %u", static_cast<unsigned>(report.histogram[NUM_BINS - 1]));
+			break;
+		default:
+			break;
+	}
+}
+
+void Profiler::add(Timing& timing, const uint32_t ticks){
+	if(ticks < timing.min) timing.min = ticks;
+	if(ticks > timing.max) timing.max = ticks;
+	timing.sum += ticks;
+}
+
+void Profiler::reset(){
+	current = Report{};
+	current.callback.min = UINT32_MAX;
+	for(auto& timing: current.sections) timing.min = UINT32_MAX;
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include "SpscQueue.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(STM32H750xx)
+#include "stm32h7xx.h"
+#else
+#include <chrono>
+#endif
+
+/// @brief Measures how much of its deadline every audio callback takes, and which part of the callback takes it.
+/// The audio side brackets a callback with start() and stop() and marks the end of every section with lap(), the
+/// sections may repeat within a callback (e.g. once per chunk), their times add up.
+///
+/// The time is read from the DWT cycle counter on the target and from a monotonic clock (in ns) on the host, both
+/// wrap around at 32 bits, which is seconds, the differences stay right. Every REPORT_SECONDS of audio the audio side
+/// sums up the callbacks into a Report and hands it to the control side through a queue, the control side formats
+/// it, e.g. from the main loop. Everything is in fixed buffers, nothing is allocated.
+class Profiler {
+public:
+	/// Parts of a callback, see DspCore::process()
+	enum Section {
+		MAPPING = 0,	// controls, pitch map and voice parameters, once per callback
+		VOICES,			// rendering the voices
+		EFFECTS,		// the effect chain
+		OUTPUT,			// gains and the copy to the output
+		NUM_SECTIONS
+	};
+
+	/// Callbacks by their share of the deadline, 10 % per bin. The last bin holds the overruns
+	static const int NUM_BINS = 11;
+
+	static constexpr float REPORT_SECONDS = 1.f;
+
+	/// Lines of format()
+	static const int NUM_LINES = 3;
+
+	/// @brief Time of one part of the callbacks, in ticks of the clock, see getTicksPerSecond()
+	struct Timing {
+		uint32_t min;
+		uint32_t max;
+		uint64_t sum;
+	};
+
+	/// @brief The callbacks of one report period
+	struct Report {
+		uint32_t callbacks;
+		uint32_t samples;
+		Timing callback;
+		Timing sections[NUM_SECTIONS];	// per callback
+		uint32_t histogram[NUM_BINS];	// see NUM_BINS
+		uint32_t peakLoad;				// highest share of the deadline a callback took, per mille
+		uint32_t totalOverruns;			// since init()
+	};
+
+	Profiler() = default;
+	~Profiler() = default;
+
+	/// @brief Starts the clock and the first report period
+	void init(const float sampleRate);
+
+	/// @brief Audio side. At the start of a callback
+	void start(){
+		startTime = now();
+		lapTime = startTime;
+		for(auto& ticks: sectionTicks) ticks = 0;
+	}
+
+	/// @brief Audio side. At the end of a section, it took the time since the previous lap() or start()
+	void lap(const Section section){
+		const uint32_t time = now();
+		sectionTicks[section] += time - lapTime;
+		lapTime = time;
+	}
+
+	/// @brief Audio side. At the end of a callback, adds it to the report and publishes the report at the end of
+	/// the period
+	/// @param size Number of samples of the callback, its deadline
+	void stop(const size_t size);
+
+	/// @brief Control side. Takes the oldest published report
+	/// @return false if there is none
+	bool popReport(Report& report) { return reports.pop(report); }
+
+	/// @brief Writes one line of a compact summary of a report, times in us
+	/// @param line 0 - NUM_LINES - 1: the callbacks, the sections and the histogram
+	void format(const Report& report, const int line, char* text, const size_t size) const;
+
+	float getTicksPerSecond() const { return ticksPerSecond; }
+
+private:
+	static uint32_t now(){
+#if defined(STM32H750xx)
+		return DWT->CYCCNT;
+#else
+		return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+	}
+
+	static void add(Timing& timing, const uint32_t ticks);
+	void reset();
+
+	float ticksPerSecond{1e9f};
+	float ticksPerSample{0.f};
+	uint32_t reportSamples{48000};
+
+	uint32_t startTime{0};
+	uint32_t lapTime{0};
+	uint32_t sectionTicks[NUM_SECTIONS]{};
+	uint32_t totalOverruns{0};
+
+	Report current{}; // audio side
+	SpscQueue<Report, 2> reports;
+};
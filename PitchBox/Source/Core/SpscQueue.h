@@ -0,0 +1,59 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/// @brief Lock-free ring buffer for exactly one producer and one consumer, e.g. the main loop and the audio callback.
+/// Neither side ever waits: push() fails when the queue is full, pop() when it's empty. Items are copied in and out,
+/// so T should be small and trivially copyable.
+template <typename T, size_t CAPACITY>
+class SpscQueue {
+	static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "the capacity has to be a power of two");
+
+public:
+	SpscQueue() = default;
+	~SpscQueue() = default;
+
+	SpscQueue(const SpscQueue&) = delete;
+	SpscQueue& operator=(const SpscQueue&) = delete;
+
+	/// @brief Producer side. Appends a copy of the item.
+	/// @return false if the queue is full, nothing is stored then
+	bool push(const T& item){
+		const uint32_t write = writeIndex.load(std::memory_order_relaxed);
+		if(write - readIndex.load(std::memory_order_acquire) == CAPACITY) return false;
+
+		items[write & MASK] = item;
+		writeIndex.store(write + 1, std::memory_order_release);
+		return true;
+	}
+
+	/// @brief Consumer side. Takes the oldest item.
+	/// @return false if the queue is empty, item is left untouched then
+	bool pop(T& item){
+		const uint32_t read = readIndex.load(std::memory_order_relaxed);
+		if(read == writeIndex.load(std::memory_order_acquire)) return false;
+
+		item = items[read & MASK];
+		readIndex.store(read + 1, std::memory_order_release);
+		return true;
+	}
+
+	/// @brief Consumer side. The oldest item without taking it, nullptr if the queue is empty.
+	const T* peek() const {
+		const uint32_t read = readIndex.load(std::memory_order_relaxed);
+		if(read == writeIndex.load(std::memory_order_acquire)) return nullptr;
+		return &items[read & MASK];
+	}
+
+	bool isEmpty() const { return readIndex.load(std::memory_order_acquire) == writeIndex.load(std::memory_order_acquire); }
+
+private:
+	static const uint32_t MASK = CAPACITY - 1;
+
+	T items[CAPACITY];
+
+	// each index on its own cache line, so the two sides don't keep invalidating each other's line
+	alignas(64) std::atomic<uint32_t> writeIndex{0};
+	alignas(64) std::atomic<uint32_t> readIndex{0};
+};
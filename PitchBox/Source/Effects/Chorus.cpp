@@ -0,0 +1,77 @@
+#include "Chorus.h"
+#include "../FM/SineKernel.h"
+
+#include <algorithm>
+
+void ChorusStage::setLine(Line* newLine){
+	line = newLine;
+	writePosition = 0;
+	if(line) std::fill(line->samples, line->samples + Line::SIZE, 0.f);
+}
+
+void ChorusStage::init(const float newSampleRate){
+	sampleRate = newSampleRate;
+	lfoPhase = 0.f;
+	lfoStep = RATE_HZ * UPDATE_INTERVAL / sampleRate;
+	for(int tap = 0; tap < NUM_TAPS; tap++){
+		delays[tap] = (DELAY_MS + DEPTH_MS * sine::fromTable(static_cast<float>(tap) / NUM_TAPS)) * 0.001f * sampleRate;
+	}
+	setLine(line);
+}
+
+void ChorusStage::process(float* buffer, const size_t size){
+	processStereo(buffer, monoRight, size);
+	for(size_t i = 0; i < size; i++) buffer[i] = 0.5f * (buffer[i] + monoRight[i]);
+}
+
+void ChorusStage::processStereo(float* __restrict left, float* __restrict right, const size_t size){
+	if(!line){
+		std::copy(left, left + size, right);
+		return;
+	}
+
+	const uint32_t mask = Line::SIZE - 1;
+	float* const samples = line->samples;
+
+	for(size_t offset = 0; offset < size; offset += UPDATE_INTERVAL){
+		const size_t count = offset + UPDATE_INTERVAL < size ? UPDATE_INTERVAL : size - offset;
+
+		// the delays at the end of the interval, from the sine table, and the steps towards them
+		lfoPhase += lfoStep * count / UPDATE_INTERVAL;
+		if(lfoPhase >= 1.f) lfoPhase -= 1.f;
+
+		float delay[NUM_TAPS];
+		float step[NUM_TAPS];
+		for(int tap = 0; tap < NUM_TAPS; tap++){
+			const float target = (DELAY_MS + DEPTH_MS * sine::fromTable(lfoPhase + static_cast<float>(tap) / NUM_TAPS)) *
+				0.001f * sampleRate;
+			delay[tap] = delays[tap];
+			step[tap] = (target - delays[tap]) / static_cast<float>(count);
+			delays[tap] = target;
+		}
+
+		for(size_t i = offset; i < offset + count; i++){
+			float taps[NUM_TAPS];
+			for(int tap = 0; tap < NUM_TAPS; tap++){
+				delay[tap] += step[tap];
+
+				// linear interpolation between the two samples around the delay, at least one sample back. One line
+				// ahead keeps the position positive, so the conversion truncates to its floor
+				const float position = static_cast<float>(writePosition + Line::SIZE) - delay[tap];
+				const uint32_t whole = static_cast<uint32_t>(position);
+				const float fraction = position - static_cast<float>(whole);
+				const uint32_t index = whole & mask;
+				const float a = samples[index];
+				const float b = samples[(index + 1) & mask];
+				taps[tap] = a + fraction * (b - a);
+			}
+
+			samples[writePosition] = left[i] + FEEDBACK * (taps[0] + taps[1] + taps[2]) * (1.f / NUM_TAPS);
+			writePosition = (writePosition + 1) & mask;
+
+			// 1 / 1.5 keeps the level of a single tap
+			left[i] = (taps[0] + 0.5f * taps[1]) * (1.f / 1.5f);
+			right[i] = (taps[2] + 0.5f * taps[1]) * (1.f / 1.5f);
+		}
+	}
+}
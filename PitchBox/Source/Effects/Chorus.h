@@ -0,0 +1,51 @@
+#pragma once
+#include "EffectChain.h"
+#include <cstddef>
+#include <cstdint>
+
+/// @brief Stereo chorus stage: three taps on one delay line, their delays swept by sines a third of a cycle apart.
+/// The left channel is the first tap plus half the middle one, the right channel the last tap plus half the middle
+/// one. The taps' average is fed back into the line. The output is wet only, the chain blends it with the dry signal.
+///
+/// The sweep is computed at control rate: the sines are read from the table of the voices every UPDATE_INTERVAL
+/// samples and the delays ramp linearly in between, every sample costs three interpolated reads and a write.
+/// The delay line is large and read sparsely, it's passed in so the firmware can keep it in SDRAM.
+class ChorusStage : public EffectStage {
+public:
+	static const int NUM_TAPS = 3;
+
+	/// The delays are recomputed every this many samples
+	static const size_t UPDATE_INTERVAL = 16;
+
+	/// @brief Storage of the delay line, 42 ms at 48 kHz. Meant for SDRAM, see Core/Memory.h
+	struct Line {
+		static const size_t SIZE = 2048; // power of two, the position wraps with a mask
+		float samples[SIZE];
+	};
+
+	// Same sound as the DaisySP chorus the instrument used: 8 ms, swept by up to 7 ms at 6.5 Hz, half fed back
+	static constexpr float DELAY_MS = 8.f;
+	static constexpr float DEPTH_MS = 7.f;
+	static constexpr float RATE_HZ = 6.5f;
+	static constexpr float FEEDBACK = 0.5f;
+
+	/// @brief Sets the storage of the delay line and clears it. Without one the stage passes its input through
+	void setLine(Line* newLine);
+
+	void init(const float sampleRate) override;
+
+	/// @brief Mono output, the average of both channels
+	void process(float* buffer, const size_t size) override;
+	void processStereo(float* left, float* right, const size_t size) override;
+
+private:
+	Line* line{nullptr};
+	uint32_t writePosition{0};
+
+	float sampleRate{48000.f};
+	float lfoPhase{0.f};	// cycles
+	float lfoStep{0.f};		// cycles per UPDATE_INTERVAL
+	float delays[NUM_TAPS]{}; // samples, at the start of the next interval
+
+	float monoRight[EffectChain::MAX_BLOCK_SIZE]; // the right channel of process()
+};
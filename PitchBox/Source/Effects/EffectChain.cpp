@@ -0,0 +1,129 @@
+#include "EffectChain.h"
+
+#include <algorithm>
+
+namespace {
+	/// Replaces buffer by its blend with dry, mix is the amount of buffer of every sample
+	void blend(float* __restrict buffer, const float* __restrict dry, const float* __restrict mix, const size_t size){
+		for(size_t j = 0; j < size; j++) buffer[j] = (1 - mix[j]) * dry[j] + mix[j] * buffer[j];
+	}
+
+	void run(EffectStage& effect, float* left, float* right, const size_t size){
+		if(right) effect.processStereo(left, right, size);
+		else effect.process(left, size);
+	}
+}
+
+int EffectChain::addStage(EffectStage& effect, const Blend blend, const bool isEnabled){
+	if(numStages == MAX_STAGES) return -1;
+
+	auto& stage = stages[numStages];
+	stage.effect = &effect;
+	stage.blend = blend;
+	stage.isEnabled = isEnabled;
+	stage.fade.setCurrentAndTargetValue(isEnabled ? 1.f : 0.f);
+	return static_cast<int>(numStages++);
+}
+
+void EffectChain::init(const float sampleRate){
+	wetSmoothing.setSampleRate(sampleRate);
+
+	for(size_t i = 0; i < numStages; i++){
+		stages[i].fade.setSampleRate(sampleRate);
+		stages[i].effect->init(sampleRate);
+	}
+}
+
+void EffectChain::setEnabled(const int stage, const bool isEnabled){
+	stages[stage].isEnabled = isEnabled;
+	stages[stage].fade.setTargetValue(isEnabled ? 1.f : 0.f);
+}
+
+void EffectChain::process(float* __restrict buffer, float* __restrict right, const size_t size){
+	// the wet amount is only rendered if a MIXED stage is going to use it
+	bool isWetUsed = false;
+	for(size_t i = 0; i < numStages; i++){
+		if(stages[i].blend == Blend::MIXED && isActive(i)) isWetUsed = true;
+	}
+
+	if(isWetUsed) wetSmoothing.process(wetBuffer, size);
+	else wetSmoothing.advance(size);
+
+	if(right && numStages == 0) std::copy(buffer, buffer + size, right);
+
+	for(size_t i = 0; i < numStages; i++){
+		auto& stage = stages[i];
+		float* const stageRight = i + 1 == numStages ? right : nullptr; // only the last stage is stereo
+		const size_t latency = stage.effect->getLatency();
+		if(!isActive(i)){ // bypassed
+			if(latency > 0) updateHistory(stage, buffer, size, latency);
+			if(stageRight) std::copy(buffer, buffer + size, stageRight);
+			continue;
+		}
+
+		const bool isFading = stage.fade.isSmoothing();
+		if(latency > 0){
+			delay(stage, buffer, size, latency);
+			updateHistory(stage, buffer, size, latency);
+		}
+
+		if(!isFading && stage.blend == Blend::WET){
+			run(*stage.effect, buffer, stageRight, size);
+			continue;
+		}
+
+		if(latency > 0){
+			processDelayed(stage, buffer, stageRight, size, isFading);
+			continue;
+		}
+
+		// amount of the stage of every sample, the wet amount scaled by the fade
+		const float* mix = wetBuffer;
+		if(isFading){
+			stage.fade.process(mixBuffer, size);
+			if(stage.blend == Blend::MIXED){
+				for(size_t j = 0; j < size; j++) mixBuffer[j] *= wetBuffer[j];
+			}
+			mix = mixBuffer;
+		}
+
+		std::copy(buffer, buffer + size, dryBuffer);
+		run(*stage.effect, buffer, stageRight, size);
+		blend(buffer, dryBuffer, mix, size);
+		if(stageRight) blend(stageRight, dryBuffer, mix, size);
+	}
+}
+
+void EffectChain::processDelayed(Stage& stage, float* __restrict buffer, float* __restrict right, const size_t size,
+	const bool isFading){
+	std::copy(buffer, buffer + size, dryBuffer);
+	run(*stage.effect, buffer, right, size);
+
+	// the output of a MIXED stage is blended with the delayed input
+	if(stage.blend == Blend::MIXED){
+		blend(buffer, delayedBuffer, wetBuffer, size);
+		if(right) blend(right, delayedBuffer, wetBuffer, size);
+	}
+
+	// and the blend crossfaded with the undelayed input
+	if(isFading){
+		stage.fade.process(mixBuffer, size);
+		blend(buffer, dryBuffer, mixBuffer, size);
+		if(right) blend(right, dryBuffer, mixBuffer, size);
+	}
+}
+
+void EffectChain::delay(Stage& stage, const float* buffer, const size_t size, const size_t latency){
+	for(size_t j = 0; j < size; j++) delayedBuffer[j] = j < latency ? stage.history[j] : buffer[j - latency];
+}
+
+void EffectChain::updateHistory(Stage& stage, const float* buffer, const size_t size, const size_t latency){
+	if(size >= latency){
+		std::copy(buffer + size - latency, buffer + size, stage.history);
+		return;
+	}
+
+	// blocks shorter than the latency, the history moves up by the block
+	std::copy(stage.history + size, stage.history + latency, stage.history);
+	std::copy(buffer, buffer + size, stage.history + latency - size);
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include "../Mappings/Smoothing.h"
+#include <algorithm>
+#include <cstddef>
+
+/// @brief One effect of the chain, processes whole blocks in place. Only called while the stage is audible, a
+/// bypassed stage isn't called at all, so it keeps the state it had when it was turned off.
+class EffectStage {
+public:
+	virtual ~EffectStage() = default;
+
+	/// @brief Prepares the stage for given sample rate, called from EffectChain::init()
+	virtual void init(const float sampleRate) = 0;
+
+	/// @brief Processes one block in place
+	/// @param buffer Samples, replaced by the output of the stage
+	/// @param size Number of samples, at most EffectChain::MAX_BLOCK_SIZE
+	virtual void process(float* buffer, const size_t size) = 0;
+
+	/// @brief Processes one block into two channels, only called for the last stage of a stereo chain. By default the
+	/// stage is mono, both channels get the output of process()
+	/// @param left Samples, replaced by the left output of the stage
+	/// @param right Receives the right output
+	virtual void processStereo(float* left, float* right, const size_t size){
+		process(left, size);
+		std::copy(left, left + size, right);
+	}
+
+	/// @brief Delay of the output in samples, at most EffectChain::MAX_LATENCY. The chain delays the dry signal the
+	/// stage is blended with by as much.
+	virtual size_t getLatency() const { return 0; }
+};
+
+/// @brief The effects after the voice mix, an ordered list of stages. Which stages run and how they are blended is
+/// resolved once per block:
+/// - a bypassed stage costs nothing, it isn't called
+/// - a stage which is on processes the block in place, MIXED stages are blended with their input by the wet amount
+/// - a stage which was just turned on or off is crossfaded with its input over the fade time
+/// Stages with latency are blended with their input delayed by as much, and crossfaded with the undelayed input.
+/// While such a stage is on, everything after it is delayed, the delay only comes and goes with the fades.
+/// The chain is mono up to its last stage, which may split the signal into two channels, see
+/// EffectStage::processStereo(). Both channels are blended with the same mono input.
+class EffectChain {
+public:
+	/// How a stage's output replaces its input
+	enum class Blend {
+		WET,	// completely, e.g. a filter
+		MIXED	// blended with the input by the wet amount, see setWet()
+	};
+
+	static const size_t MAX_STAGES = 4;
+	static const size_t MAX_BLOCK_SIZE = 64;
+	static const size_t MAX_LATENCY = 32;
+
+	/// Crossfade of a stage which is turned on or off
+	static constexpr float FADE_MS = 5.f;
+
+	EffectChain() = default;
+	~EffectChain() = default;
+
+	/// @brief Appends a stage to the chain, the stages run in the order they are added
+	/// @param isEnabled Whether the stage starts on, without a fade
+	/// @return The index of the stage, -1 if the chain is full
+	int addStage(EffectStage& stage, const Blend blend, const bool isEnabled = false);
+
+	/// @brief Sets the sample rate of the fades and initialises all stages
+	void init(const float sampleRate);
+
+	/// @brief Turns a stage on or off, it's faded in or out over FADE_MS
+	void setEnabled(const int stage, const bool isEnabled);
+	bool isEnabled(const int stage) const { return stages[stage].isEnabled; }
+
+	/// @brief Whether a stage is processed at the moment, turned on or still fading out
+	bool isActive(const int stage) const { return stages[stage].fade.isSmoothing() || stages[stage].isEnabled; }
+
+	/// @brief Sets the wet amount of the MIXED stages, 0 - 1. It's ramped over 25 ms.
+	void setWet(const float wet) { wetSmoothing.setTargetValue(wet); }
+
+	/// @brief Runs the block through all active stages
+	/// @param buffer Samples, replaced by the output of the chain
+	/// @param size Number of samples, at most MAX_BLOCK_SIZE
+	void process(float* buffer, const size_t size) { process(buffer, nullptr, size); }
+
+	/// @brief Runs the block through all active stages, the last one with two output channels
+	/// @param left Samples, replaced by the left output of the chain
+	/// @param right Receives the right output, a copy of the left one while the last stage is bypassed
+	/// @param size Number of samples, at most MAX_BLOCK_SIZE
+	void process(float* left, float* right, const size_t size);
+
+private:
+	struct Stage {
+		EffectStage* effect{nullptr};
+		Blend blend{Blend::WET};
+		bool isEnabled{false};
+		Smoothing fade{FADE_MS}; // 0 - 1, the amount of the stage in its output
+		float history[MAX_LATENCY]{}; // the last inputs, for stages with latency
+	};
+
+	/// Processes a stage with latency which is on or fading, right is null unless it's the last stage of a stereo chain
+	void processDelayed(Stage& stage, float* buffer, float* right, const size_t size, const bool isFading);
+	/// Writes the input delayed by the stage's latency to delayedBuffer
+	void delay(Stage& stage, const float* buffer, const size_t size, const size_t latency);
+	/// Keeps the last inputs of a stage with latency, also while it's bypassed so it can fade in cleanly
+	void updateHistory(Stage& stage, const float* buffer, const size_t size, const size_t latency);
+
+	Stage stages[MAX_STAGES];
+	size_t numStages{0};
+
+	Smoothing wetSmoothing{25.f};
+
+	float dryBuffer[MAX_BLOCK_SIZE];
+	float delayedBuffer[MAX_BLOCK_SIZE];	// dry signal delayed by the latency of the current stage
+	float wetBuffer[MAX_BLOCK_SIZE];	// wet amount of every sample
+	float mixBuffer[MAX_BLOCK_SIZE];	// amount of the current stage of every sample
+};
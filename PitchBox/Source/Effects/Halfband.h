@@ -0,0 +1,144 @@
+#pragma once
+#include "../FM/Lanes.h"
+#include <cstddef>
+
+/// @brief Halfband FIR filters for changing the sample rate by 2. Every other tap of a halfband filter is zero and
+/// the center one is 1/2, so in the polyphase form one phase is a pure delay and the other a short symmetric FIR.
+/// The filters are Kaiser windowed sincs, only the first half of the nonzero taps is stored, outermost first.
+namespace halfband {
+	/// 39 taps, beta 6. Flat to 0.1875 fs (18 kHz at 96 kHz, within 0.005 dB), -67 dB from 0.3125 fs (30 kHz).
+	/// For the first doubling, its transition band is what folds back into the audio band.
+	const int STEEP_TAPS = 10;
+	const float STEEP[STEEP_TAPS] = {-2.491814906e-04f, 1.052878639e-03f, -2.717897827e-03f, 5.707912433e-03f,
+		-1.064907027e-02f, 1.848745561e-02f, -3.098618462e-02f, 5.251087362e-02f, -9.906878206e-02f, 3.159119960e-01f};
+
+	/// 15 taps, beta 5. Flat to 0.125 fs (24 kHz at 192 kHz, within 0.02 dB), -53 dB from 0.375 fs (72 kHz).
+	/// Enough for the second doubling, the signal below it is already band limited to a quarter of its rate.
+	const int WIDE_TAPS = 4;
+	const float WIDE[WIDE_TAPS] = {-1.666171618e-03f, 1.720014577e-02f, -6.901997180e-02f, 3.034859976e-01f};
+
+	/// Inputs are processed in chunks of this size, the history is kept in front of them
+	const size_t CHUNK_SIZE = 64;
+
+	/// @brief The FIR phase at newest[0] to newest[3], the inputs of newest[0] are newest[0] back to
+	/// newest[1 - 2 * TAPS]. The taps are symmetric, so both ends share a multiplication. Four independent sums, a
+	/// single one would wait for the previous addition on every tap.
+	template <int TAPS>
+	inline lanes::float4 filter4(const float* taps, const float* newest){
+		using namespace lanes;
+		float4 sum = broadcast(0.f);
+		for(int k = 0; k < TAPS; k++) sum += broadcast(taps[k]) * (load(newest - k) + load(newest + k + 1 - 2 * TAPS));
+		return sum;
+	}
+}
+
+/// @brief Doubles the sample rate. Every input sample gives two outputs: the FIR phase (the midpoint between
+/// two inputs) and the delay phase (an input sample). LATE swaps their order, which delays the output by one more
+/// sample for free, see getLatency().
+/// @tparam TAPS Number of stored taps, halfband::STEEP_TAPS or halfband::WIDE_TAPS
+template <int TAPS, bool LATE = false>
+class HalfbandUpsampler {
+public:
+	explicit HalfbandUpsampler(const float* taps) : taps(taps) { reset(); }
+
+	/// @brief Delay in samples of the output rate
+	static constexpr int getLatency() { return 2 * TAPS - 1 + (LATE ? 1 : 0); }
+
+	/// @brief Clears the history
+	void reset(){
+		for(auto& sample: work) sample = 0.f;
+	}
+
+	/// @param in size samples
+	/// @param out 2 * size samples
+	void process(const float* in, float* out, const size_t size){
+		for(size_t offset = 0; offset < size; offset += halfband::CHUNK_SIZE){
+			const int chunk = static_cast<int>(size - offset < halfband::CHUNK_SIZE ? size - offset : halfband::CHUNK_SIZE);
+			processChunk(in + offset, out + 2 * offset, chunk);
+		}
+	}
+
+private:
+	static const int HISTORY = 2 * TAPS - 1;
+	static const int DELAY_OFFSET = LATE ? -TAPS : 1 - TAPS; // of the input sample of the delay phase
+
+	void processChunk(const float* __restrict in, float* __restrict out, const int size){
+		for(int i = 0; i < size; i++) work[HISTORY + i] = in[i];
+
+		// the halfband's 1/2 times the 2 which restores the gain after inserting zeros. Four outputs at a time, the
+		// lanes past the end of a chunk read the padding and aren't stored
+		for(int n = 0; n < size; n += lanes::WIDTH){
+			const float* newest = work + HISTORY + n;
+			const lanes::float4 filtered = lanes::broadcast(2.f) * halfband::filter4<TAPS>(taps, newest);
+			const lanes::float4 delayed = lanes::load(newest + DELAY_OFFSET);
+			const lanes::float4 first = LATE ? delayed : filtered;
+			const lanes::float4 second = LATE ? filtered : delayed;
+			if(n + lanes::WIDTH <= size){
+				lanes::store(out + 2 * n, lanes::float4{first[0], second[0], first[1], second[1]});
+				lanes::store(out + 2 * n + lanes::WIDTH, lanes::float4{first[2], second[2], first[3], second[3]});
+			}
+			else for(int j = 0; n + j < size; j++){
+				out[2 * (n + j)] = first[j];
+				out[2 * (n + j) + 1] = second[j];
+			}
+		}
+
+		for(int i = 0; i < HISTORY; i++) work[i] = work[size + i];
+	}
+
+	const float* taps;
+	float work[HISTORY + halfband::CHUNK_SIZE + lanes::WIDTH - 1];
+};
+
+/// @brief Halves the sample rate. Every pair of inputs gives one output: the FIR over one phase plus the other
+/// phase delayed. LATE filters the other phase, which delays the output by one more input sample, see getLatency().
+/// @tparam TAPS Number of stored taps, halfband::STEEP_TAPS or halfband::WIDE_TAPS
+template <int TAPS, bool LATE = false>
+class HalfbandDownsampler {
+public:
+	explicit HalfbandDownsampler(const float* taps) : taps(taps) { reset(); }
+
+	/// @brief Delay in samples of the input rate. One less than the upsampler's, output n is taken at input 2n + 1
+	static constexpr int getLatency() { return 2 * TAPS - 2 + (LATE ? 1 : 0); }
+
+	/// @brief Clears the history
+	void reset(){
+		for(auto& sample: filtered) sample = 0.f;
+		for(auto& sample: delayed) sample = 0.f;
+	}
+
+	/// @param in 2 * size samples
+	/// @param out size samples
+	void process(const float* in, float* out, const size_t size){
+		for(size_t offset = 0; offset < size; offset += halfband::CHUNK_SIZE){
+			const int chunk = static_cast<int>(size - offset < halfband::CHUNK_SIZE ? size - offset : halfband::CHUNK_SIZE);
+			processChunk(in + 2 * offset, out + offset, chunk);
+		}
+	}
+
+private:
+	static const int HISTORY = 2 * TAPS - 1;
+	static const int DELAY = LATE ? TAPS : TAPS - 1; // of the phase which isn't filtered
+
+	void processChunk(const float* __restrict in, float* __restrict out, const int size){
+		// the even inputs are filtered in the late variant, the odd ones otherwise
+		for(int i = 0; i < size; i++){
+			filtered[HISTORY + i] = in[2 * i + (LATE ? 0 : 1)];
+			delayed[DELAY + i] = in[2 * i + (LATE ? 1 : 0)];
+		}
+
+		for(int n = 0; n < size; n += lanes::WIDTH){
+			const lanes::float4 sum = halfband::filter4<TAPS>(taps, filtered + HISTORY + n);
+			const lanes::float4 output = sum + lanes::broadcast(0.5f) * lanes::load(delayed + n);
+			if(n + lanes::WIDTH <= size) lanes::store(out + n, output);
+			else for(int j = 0; n + j < size; j++) out[n + j] = output[j];
+		}
+
+		for(int i = 0; i < HISTORY; i++) filtered[i] = filtered[size + i];
+		for(int i = 0; i < DELAY; i++) delayed[i] = delayed[size + i];
+	}
+
+	const float* taps;
+	float filtered[HISTORY + halfband::CHUNK_SIZE + lanes::WIDTH - 1];
+	float delayed[TAPS + halfband::CHUNK_SIZE + lanes::WIDTH - 1];
+};
@@ -0,0 +1,101 @@
+#include "LowPass.h"
+
+#include <math.h>
+
+void LowPassStage::init(const float newSampleRate){
+	sampleRate = newSampleRate;
+	cutoffSmoothing.setSampleRate(sampleRate);
+	setMode(mode);
+}
+
+void LowPassStage::setMode(const Mode newMode){
+	mode = newMode;
+	s1 = s2 = 0.f;
+	coefficients = coefficientsFor(cutoffSmoothing.getCurrentValue());
+}
+
+void LowPassStage::setResonance(const float q){
+	damping = 1.f / fmaxf(q, 0.5f);
+	isDirty = true;
+}
+
+LowPassStage::Coefficients LowPassStage::coefficientsFor(const float cutoff) const{
+	const float ratio = fminf(cutoff / sampleRate, lowpass::MAX_CUTOFF_RATIO);
+	const float g = lowpass::tan(3.14159265f * ratio);
+
+	Coefficients result;
+	if(mode == Mode::ONE_POLE){
+		result.a2 = g / (1.f + g);
+	}
+	else{
+		result.a1 = 1.f / (1.f + g * (g + damping));
+		result.a2 = g * result.a1;
+		result.a3 = g * result.a2;
+	}
+	return result;
+}
+
+void LowPassStage::process(float* buffer, const size_t size){
+	for(size_t i = 0; i < size; i += UPDATE_INTERVAL){
+		const size_t count = i + UPDATE_INTERVAL < size ? UPDATE_INTERVAL : size - i;
+
+		// the coefficients at the end of the interval, the samples before it step towards them
+		const Coefficients from = coefficients;
+		Coefficients step{0.f, 0.f, 0.f};
+		if(cutoffSmoothing.isSmoothing() || isDirty){
+			coefficients = coefficientsFor(cutoffSmoothing.advance(UPDATE_INTERVAL));
+			isDirty = false;
+
+			const float scale = 1.f / static_cast<float>(count);
+			step.a1 = (coefficients.a1 - from.a1) * scale;
+			step.a2 = (coefficients.a2 - from.a2) * scale;
+			step.a3 = (coefficients.a3 - from.a3) * scale;
+		}
+
+		const bool isRamp = step.a1 != 0.f || step.a2 != 0.f || step.a3 != 0.f;
+		if(mode == Mode::ONE_POLE){
+			if(isRamp) render<Mode::ONE_POLE, true>(buffer + i, count, from, step);
+			else render<Mode::ONE_POLE, false>(buffer + i, count, from, step);
+		}
+		else{
+			if(isRamp) render<Mode::SVF, true>(buffer + i, count, from, step);
+			else render<Mode::SVF, false>(buffer + i, count, from, step);
+		}
+	}
+}
+
+template <LowPassStage::Mode MODE, bool IS_RAMP>
+void LowPassStage::render(float* __restrict buffer, const size_t size, const Coefficients& from, const Coefficients& step){
+	float a1 = from.a1;
+	float a2 = from.a2;
+	float a3 = from.a3;
+	float state1 = s1;
+	float state2 = s2;
+
+	for(size_t i = 0; i < size; i++){
+		if(IS_RAMP){
+			a1 += step.a1;
+			a2 += step.a2;
+			a3 += step.a3;
+		}
+
+		if(MODE == Mode::ONE_POLE){
+			// low = s + a2 (x - s) and s' = 2 low - s, rearranged so that the state only waits for one
+			// multiply-add per sample
+			const float x = buffer[i];
+			buffer[i] = state1 + a2 * (x - state1);
+			state1 = (1.f - 2.f * a2) * state1 + 2.f * a2 * x;
+		}
+		else{
+			const float v3 = buffer[i] - state2;
+			const float v1 = a1 * state1 + a2 * v3;
+			const float v2 = state2 + a2 * state1 + a3 * v3;
+			state1 = 2.f * v1 - state1;
+			state2 = 2.f * v2 - state2;
+			buffer[i] = v2;
+		}
+	}
+
+	s1 = state1;
+	s2 = state2;
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include "EffectChain.h"
+#include "../Mappings/Smoothing.h"
+
+namespace lowpass {
+	/// @brief tan(x) for 0 <= x < pi / 2, the [3/4] Padé approximant. Within 0.04 % up to 0.42 fs (20 kHz at 48 kHz),
+	/// within 0.12 % at 0.45 fs. One division instead of sin and cos.
+	inline float tan(const float x){
+		const float x2 = x * x;
+		return x * (105.f - 10.f * x2) / (105.f + x2 * (x2 - 45.f));
+	}
+
+	/// Cutoffs are limited to this fraction of the sample rate, tan() grows without bound towards 0.5
+	const float MAX_CUTOFF_RATIO = 0.45f;
+}
+
+/// @brief Low pass stage of the effect chain, zero-delay-feedback (TPT) filters: a one-pole, 6 dB/octave like the
+/// DaisySP Tone it replaces, or a state variable filter, 12 dB/octave with resonance.
+///
+/// The coefficients are cached. While the cutoff ramps they are recomputed once every UPDATE_INTERVAL samples, with
+/// an approximate tan, and interpolated linearly over the samples in between. Once the cutoff rests nothing is
+/// computed at all.
+class LowPassStage : public EffectStage {
+public:
+	enum class Mode {
+		ONE_POLE,
+		SVF
+	};
+
+	/// The coefficients are recomputed every this many samples while the cutoff moves
+	static const size_t UPDATE_INTERVAL = 16;
+
+	void init(const float sampleRate) override;
+	void process(float* buffer, const size_t size) override;
+
+	/// @brief Sets the cutoff frequency in Hz, it's ramped over 25 ms
+	void setCutoff(const float cutoff) { cutoffSmoothing.setTargetValue(cutoff); }
+
+	/// @brief Switches the filter, its state is cleared. Not meant for while the stage is audible
+	void setMode(const Mode newMode);
+	Mode getMode() const { return mode; }
+
+	/// @brief Sets the resonance of the SVF as its Q, 0.707 is flat. Takes effect with the next coefficient update
+	void setResonance(const float q);
+
+private:
+	struct Coefficients {
+		float a1{1.f};
+		float a2{0.f}; // the one-pole's only coefficient, g / (1 + g)
+		float a3{0.f};
+	};
+
+	Coefficients coefficientsFor(const float cutoff) const;
+
+	template <Mode MODE, bool IS_RAMP>
+	void render(float* buffer, const size_t size, const Coefficients& from, const Coefficients& step);
+
+	float sampleRate{48000.f};
+	Mode mode{Mode::ONE_POLE};
+	float damping{1.41421356f}; // 1 / Q
+
+	Smoothing cutoffSmoothing{25.f, Smoothing::Mode::EXPONENTIAL};
+	Coefficients coefficients;
+	bool isDirty{false}; // the resonance changed
+
+	// integrator states
+	float s1{0.f};
+	float s2{0.f};
+};
@@ -0,0 +1,46 @@
+#include "OversampledOverdrive.h"
+
+// the shaper and the halfband filters work on ratios of the rate, the stage doesn't depend on the sample rate
+void OversampledOverdriveStage::init(const float /*sampleRate*/){
+	overdrive.Init();
+	overdrive.SetDrive(0.4f);
+	setFactor(factor);
+}
+
+void OversampledOverdriveStage::setFactor(const int newFactor){
+	factor = newFactor >= 4 && MAX_FACTOR >= 4 ? 4 : (newFactor >= 2 && MAX_FACTOR >= 2 ? 2 : 1);
+
+	up2.reset();
+	down2.reset();
+	up4.reset();
+	down4.reset();
+	down2Of4.reset();
+}
+
+size_t OversampledOverdriveStage::getLatency() const{
+	if(factor == 4) return LATENCY_4;
+	if(factor == 2) return LATENCY_2;
+	return 0;
+}
+
+void OversampledOverdriveStage::shape(float* __restrict buffer, const size_t size){
+	for(size_t i = 0; i < size; i++) buffer[i] = overdrive.Process(buffer[i]);
+}
+
+void OversampledOverdriveStage::process(float* buffer, const size_t size){
+	if(MAX_FACTOR >= 4 && factor == 4){
+		up2.process(buffer, doubled, size);
+		up4.process(doubled, oversampled, 2 * size);
+		shape(oversampled, 4 * size);
+		down4.process(oversampled, doubled, 2 * size);
+		down2Of4.process(doubled, buffer, size);
+	}
+	else if(MAX_FACTOR >= 2 && factor == 2){
+		up2.process(buffer, oversampled, size);
+		shape(oversampled, 2 * size);
+		down2.process(oversampled, buffer, size);
+	}
+	else{
+		shape(buffer, size);
+	}
+}
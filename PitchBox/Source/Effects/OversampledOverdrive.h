@@ -0,0 +1,60 @@
+#pragma once
+#include "daisysp.h"
+
+#include "EffectChain.h"
+#include "Halfband.h"
+
+// Highest oversampling factor of the overdrive, 1, 2 or 4. Select it with OVERSAMPLING=1|2|4 in the Makefile,
+// the buffers are sized for it. Lower factors can still be chosen at run time, see setFactor().
+#ifndef OVERDRIVE_OVERSAMPLING
+#define OVERDRIVE_OVERSAMPLING 2
+#endif
+
+/// @brief The waveshaper of daisysp::Overdrive at 2 or 4 times the sample rate. The FM voices are rich in
+/// harmonics, the shaper adds more and at the base rate everything above Nyquist folds back as aliasing.
+/// Halfband filters double the rate once or twice before the shaper and halve it again after it, whole blocks at a
+/// time. The filters delay the output, see getLatency(), the effect chain delays the dry signal to match.
+class OversampledOverdriveStage : public EffectStage {
+public:
+	static const int MAX_FACTOR = OVERDRIVE_OVERSAMPLING;
+	static_assert(MAX_FACTOR == 1 || MAX_FACTOR == 2 || MAX_FACTOR == 4, "OVERDRIVE_OVERSAMPLING must be 1, 2 or 4");
+
+	void init(const float sampleRate) override;
+	void process(float* buffer, const size_t size) override;
+	size_t getLatency() const override;
+
+	/// @brief Sets the oversampling factor, 1, 2 or 4, at most MAX_FACTOR. Clears the filters and changes the
+	/// latency, meant for setting up rather than while the stage is audible
+	void setFactor(const int newFactor);
+	int getFactor() const { return factor; }
+
+private:
+	using Up2 = HalfbandUpsampler<halfband::STEEP_TAPS>;
+	using Down2 = HalfbandDownsampler<halfband::STEEP_TAPS, true>;
+	using Up4 = HalfbandUpsampler<halfband::WIDE_TAPS, true>;
+	using Down4 = HalfbandDownsampler<halfband::WIDE_TAPS>;
+	using Down2Of4 = HalfbandDownsampler<halfband::STEEP_TAPS>;
+
+	// The phases of the filters are picked so that the delays add up to whole samples of the base rate
+	static const int LATENCY_2 = (Up2::getLatency() + Down2::getLatency()) / 2;
+	static const int LATENCY_4 = (2 * Up2::getLatency() + Up4::getLatency() + Down4::getLatency() +
+		2 * Down2Of4::getLatency()) / 4;
+	static_assert((Up2::getLatency() + Down2::getLatency()) % 2 == 0, "2x latency is not a whole sample");
+	static_assert((2 * Up2::getLatency() + Up4::getLatency() + Down4::getLatency() + 2 * Down2Of4::getLatency()) % 4 == 0,
+		"4x latency is not a whole sample");
+
+	void shape(float* buffer, const size_t size);
+
+	daisysp::Overdrive overdrive;
+	int factor{MAX_FACTOR};
+
+	// 2x: up2 -> shaper -> down2, 4x: up2 -> up4 -> shaper -> down4 -> down2Of4
+	Up2 up2{halfband::STEEP};
+	Down2 down2{halfband::STEEP};
+	Up4 up4{halfband::WIDE};
+	Down4 down4{halfband::WIDE};
+	Down2Of4 down2Of4{halfband::STEEP};
+
+	float oversampled[MAX_FACTOR * EffectChain::MAX_BLOCK_SIZE];
+	float doubled[MAX_FACTOR == 4 ? 2 * EffectChain::MAX_BLOCK_SIZE : 1]; // between the two doublings of 4x
+};
@@ -0,0 +1,71 @@
+#pragma once
+#include <cmath>
+
+/// @brief Linear attack/release envelope with an explicit state, so callers can tell when a voice is fully silent
+class Envelope {
+public:
+	enum class State {
+		IDLE,		// value is 0 and stays there, nothing has to be rendered
+		ATTACK,		// ramping up towards 1
+		SUSTAIN,	// holding 1
+		RELEASE		// ramping down towards 0
+	};
+
+	/// @brief Creates an envelope in the given state. IDLE starts at 0, all other states at 1.
+	Envelope(State initialState = State::SUSTAIN) :
+		state(initialState), value(initialState == State::IDLE ? 0.f : 1.f) {};
+	~Envelope() = default;
+
+	void setSampleRate(const float newSampleRate) { sampleRate = newSampleRate; }
+
+	/// @brief Starts ramping up to 1 over given time
+	/// @param miliseconds The length of the attack phase
+	void startAttackPhase(const float miliseconds){
+		step = 1.f / (miliseconds * 0.001f * sampleRate);
+		state = State::ATTACK;
+	}
+
+	/// @brief Starts ramping down to 0 over given time
+	/// @param miliseconds The length of the release phase
+	void startDecayPhase(const float miliseconds){
+		step = -1.f / (miliseconds * 0.001f * sampleRate);
+		state = value > 0.f ? State::RELEASE : State::IDLE;
+	}
+
+	/// @brief Advances the envelope by one sample
+	/// @return The new envelope value
+	float getNextValue(){
+		value = clamp(value + step);
+		state = nextState(state, value);
+		return value;
+	}
+
+	/// @brief Stores the value reached after rendering a block with getValue()/getStep() kept in locals
+	void setValue(const float newValue){
+		value = newValue;
+		state = nextState(state, value);
+	}
+
+	float getValue() const { return value; }
+	float getStep() const { return step; }
+	State getState() const { return state; }
+
+	/// @brief True when the envelope is at 0 and not going to move, i.e. the voice can be skipped entirely
+	bool isIdle() const { return state == State::IDLE; }
+
+	/// @brief Clamps an envelope value into [0, 1]
+	static float clamp(const float x) { return ::fminf(::fmaxf(x, 0.f), 1.f); }
+
+	/// @brief Returns the state an envelope in given state is in after reaching given value
+	static State nextState(const State state, const float value){
+		if(state == State::ATTACK && value >= 1.f) return State::SUSTAIN;
+		if(state == State::RELEASE && value <= 0.f) return State::IDLE;
+		return state;
+	}
+
+private:
+	State state;
+	float value;
+	float step{0.f};
+	float sampleRate{48000.f};
+};
@@ -0,0 +1,26 @@
+#include "FmCoefficients.h"
+#include "SineKernel.h"
+
+fm::Coefficients fm::table[fm::TABLE_SIZE];
+
+fm::Coefficients fm::fromFrequency(const float frequency){
+	const auto lnfc = logf(frequency);
+
+	return {
+		frequency,
+		17 * (8 - lnfc) / (lnfc * lnfc) * sine::INV_TWO_PI,	// I1 = 17*(8-ln(fc)) / (ln(fc))^2;
+		20 * (8 - lnfc) / frequency * sine::INV_TWO_PI		// I2 = 20*(8-ln(fc)) / fc;
+	};
+}
+
+namespace {
+	/// Fills the coefficient table before main() runs
+	struct TableInitializer {
+		TableInitializer(){
+			for(int i = 0; i < fm::TABLE_SIZE; i++){
+				const float note = fm::MIN_NOTE + static_cast<float>(i) / fm::STEPS_PER_NOTE;
+				fm::table[i] = fm::fromFrequency(fm::frequencyFromNote(note));
+			}
+		}
+	} tableInitializer;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <cmath>
+
+/// @brief Schottstaedt FM coefficients of a voice as a function of its carrier. The modulation indices
+/// I1 = 17*(8-ln(fc)) / (ln(fc))^2 and I2 = 20*(8-ln(fc)) / fc only depend on the carrier frequency, so they are
+/// precomputed over the playable range and looked up by (fractional) MIDI note number.
+namespace fm {
+	const int MIN_NOTE = 36; // C2, lowest main note (48) minus an octave
+	const int MAX_NOTE = 84; // C6, highest main note (60) plus the octave interval and some headroom
+	const int STEPS_PER_NOTE = 8;
+	const int TABLE_SIZE = (MAX_NOTE - MIN_NOTE) * STEPS_PER_NOTE + 1;
+
+	/// Offset of the modulators to the carrier, S = fc / 200; fm1 = fc + S, fm2 = 4 * fc + S
+	const float S_RATIO = 0.005f;
+
+	struct Coefficients {
+		float frequency;	// carrier frequency in Hz
+		float I1;			// modulation indices, in cycles (already divided by 2*pi)
+		float I2;
+	};
+
+	/// Coefficients at MIN_NOTE + i / STEPS_PER_NOTE. Filled at start up in FmCoefficients.cpp
+	extern Coefficients table[TABLE_SIZE];
+
+	/// @brief Computes the coefficients directly from a carrier frequency (one logf and two divisions)
+	Coefficients fromFrequency(const float frequency);
+
+	/// @brief Returns the frequency of a fractional MIDI note number (A4 == 57 in this project, as in mapping::)
+	inline float frequencyFromNote(const float note){
+		return ::powf(2.f, (note - 57.f) / 12.f) * 440.f;
+	}
+
+	/// @brief Interval of a frequency ratio in semitones
+	inline float semitonesFromRatio(const float ratio){
+		return 12.f * ::log2f(ratio);
+	}
+
+	/// @brief Linearly interpolated coefficients of a fractional note. Notes outside of [MIN_NOTE, MAX_NOTE]
+	/// fall back to the exact computation. Max relative frequency error 6.5e-6 (~0.01 cent).
+	inline Coefficients fromNote(const float note){
+		const float index = (note - MIN_NOTE) * STEPS_PER_NOTE;
+		if(!(index >= 0.f && index < TABLE_SIZE - 1)) return fromFrequency(frequencyFromNote(note));
+
+		const int i = static_cast<int>(index);
+		const float frac = index - static_cast<float>(i);
+		const Coefficients& a = table[i];
+		const Coefficients& b = table[i + 1];
+
+		return {
+			a.frequency + frac * (b.frequency - a.frequency),
+			a.I1 + frac * (b.I1 - a.I1),
+			a.I2 + frac * (b.I2 - a.I2)
+		};
+	}
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include "Lanes.h"
+#include "SineKernel.h"
+#include <cstdint>
+
+/// @brief The FM algorithm of the voices, e = sin(2*pi*fc*t + I1 * sin(2*pi*(fm1+S)*t) + I2 * sin(2*pi*(fm2+S)*t)),
+/// after "The Simulation of Natural Instrument Tones using Frequency Modulation with a Complex Modulating Wave" by
+/// Bill Schottstaedt. Shared by every engine which renders the FM timbre: SinusoidSynth, the VoiceBank and the
+/// generator of the wavetables, so they can't drift apart.
+namespace fm {
+	/// @brief One sample of the voice. The phases are fixed point, see Oscillator, I1 and I2 are in cycles, see
+	/// Coefficients, so the modulation is added to the carrier as a fixed-point offset
+	inline float sample(const uint32_t carrierPhase, const uint32_t m1Phase, const uint32_t m2Phase, const float I1,
+		const float I2){
+		const auto sinM1 = sine::fromPhase(m1Phase);
+		const auto sinM2 = sine::fromPhase(m2Phase);
+		return sine::fromPhase(carrierPhase + sine::offsetToFixed(I1 * sinM1 + I2 * sinM2));
+	}
+
+	/// @brief Four lane version of sample(), one voice per lane
+	inline lanes::float4 sample(const lanes::uint4 carrierPhase, const lanes::uint4 m1Phase, const lanes::uint4 m2Phase,
+		const lanes::float4 I1, const lanes::float4 I2){
+		const auto sinM1 = sine::fromPhase(m1Phase);
+		const auto sinM2 = sine::fromPhase(m2Phase);
+		return sine::fromPhase(carrierPhase + sine::offsetToFixed(I1 * sinM1 + I2 * sinM2));
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+/// @brief The just intervals the interval voices play above the main voice. Ratios are given as template arguments
+/// and everything derived from them (the frequency ratio and the interval in semitones) is computed by the compiler,
+/// nothing is left to do for them at start up or per pitch update.
+namespace harmony {
+	struct Interval {
+		float ratio;		// carrier frequency relative to the main voice
+		float semitones;	// the same as an interval, added to the main note
+	};
+
+	/// log2, constexpr (std::log2 isn't). Scales into [1, 2), the rest is the atanh series of the natural logarithm
+	constexpr double log2(double x){
+		int exponent = 0;
+		for(; x >= 2.0; x *= 0.5) exponent++;
+		for(; x < 1.0; x *= 2.0) exponent--;
+
+		const double y = (x - 1.0) / (x + 1.0);
+		double sum = 0.0, term = y;
+		for(int k = 1; k < 40; k += 2){
+			sum += term / k;
+			term *= y * y;
+		}
+		return exponent + 2.0 * sum / 0.69314718055994530942;
+	}
+
+	template<int NUMERATOR, int DENOMINATOR>
+	constexpr Interval ratio(){
+		static_assert(NUMERATOR > 0 && DENOMINATOR > 0, "intervals are ratios of positive integers");
+		return {static_cast<float>(NUMERATOR) / DENOMINATOR, static_cast<float>(12.0 * log2(static_cast<double>(NUMERATOR) / DENOMINATOR))};
+	}
+
+	constexpr Interval UNISON = ratio<1, 1>();
+	constexpr Interval FIFTH = ratio<3, 2>();
+	constexpr Interval FOURTH = ratio<4, 3>();
+	constexpr Interval MAJOR_THIRD = ratio<5, 4>();
+	constexpr Interval MINOR_THIRD = ratio<6, 5>();
+	constexpr Interval OCTAVE = ratio<2, 1>();
+}
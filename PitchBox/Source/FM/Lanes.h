@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+/// @brief Four float lanes processed together. Uses the GCC/Clang vector extensions, which are lowered to
+/// SSE on x86, NEON on ARMv7-A/ARMv8 and to unrolled scalar FPU code on the Cortex-M7.
+namespace lanes {
+	typedef float float4 __attribute__((vector_size(16)));
+	typedef int32_t int4 __attribute__((vector_size(16)));
+	typedef uint32_t uint4 __attribute__((vector_size(16)));
+
+	const int WIDTH = 4;
+
+	inline float4 broadcast(const float value){ return float4{value, value, value, value}; }
+
+	inline float4 load(const float* src){
+		float4 v;
+		memcpy(&v, src, sizeof(v));
+		return v;
+	}
+
+	inline void store(float* dst, const float4 v){ memcpy(dst, &v, sizeof(v)); }
+
+	inline uint4 load(const uint32_t* src){
+		uint4 v;
+		memcpy(&v, src, sizeof(v));
+		return v;
+	}
+
+	inline void store(uint32_t* dst, const uint4 v){ memcpy(dst, &v, sizeof(v)); }
+
+	inline float sum(const float4 v){ return (v[0] + v[1]) + (v[2] + v[3]); }
+
+	inline float4 min(const float4 a, const float4 b){ return a < b ? a : b; }
+	inline float4 max(const float4 a, const float4 b){ return a > b ? a : b; }
+
+	inline float4 floor(const float4 v){
+		const float4 truncated = __builtin_convertvector(__builtin_convertvector(v, int4), float4);
+		return truncated > v ? truncated - broadcast(1.f) : truncated;
+	}
+
+	inline float4 abs(const float4 v){ return (float4)((uint4)v & 0x7fffffffu); }
+
+	/// @brief Magnitude of value with the sign of sign
+	inline float4 copySign(const float4 value, const float4 sign){
+		return (float4)(((uint4)value & 0x7fffffffu) | ((uint4)sign & 0x80000000u));
+	}
+}
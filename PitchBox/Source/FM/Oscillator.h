@@ -1,29 +1,40 @@
 #pragma once
+#include "SineKernel.h"
+#include <cstdint>
 
-/// @brief Simple oscillator class implementation
+/// @brief Simple oscillator class implementation. The phase is a 32 bit fixed-point accumulator where the
+/// full uint32_t range is one cycle, so it wraps for free by overflow, keeps the same precision at every
+/// frequency and stays correct for steps > 1. The float API works in cycles [0, 1) as before.
 class Oscillator {
 public:
 	Oscillator() = default;
 	~Oscillator() = default;
 
-	void setPhase(const float newPhase) { phase = newPhase; }
-	void setStep(const float newStep) { step = newStep; }
+	void setPhase(const float newPhase) { phase = sine::toFixed(newPhase); }
+	void setStep(const float newStep) { step = sine::toFixed(newStep); }
 
-	float getPhase() const { return phase; }
+	float getPhase() const { return static_cast<float>(phase) * sine::FIXED_TO_CYCLES; }
+	float getStep() const { return static_cast<float>(step) * sine::FIXED_TO_CYCLES; }
+
+	void setFixedPhase(const uint32_t newPhase) { phase = newPhase; }
+	void setFixedStep(const uint32_t newStep) { step = newStep; }
+	uint32_t getFixedPhase() const { return phase; }
+	uint32_t getFixedStep() const { return step; }
 
 	/// @brief Updates the internal phase of the oscillator and returns it.
-	/// @return Current phase of the oscillator
+	/// @return Current phase of the oscillator in cycles [0, 1)
 	float getNextPhaseValue(){
-		phase += step; // for each sample increment the phase
-
-		if(phase > 1.f){ // modulo; always keep the values between 0 and 1
-			phase -= 1.f;
-		}
+		return static_cast<float>(getNextFixedPhase()) * sine::FIXED_TO_CYCLES;
+	}
 
+	/// @brief Updates the internal phase of the oscillator and returns it in fixed point, ready for sine::fromPhase
+	/// @return Current phase of the oscillator, 2^32 == one cycle
+	uint32_t getNextFixedPhase(){
+		phase += step; // for each sample increment the phase, unsigned overflow is the modulo
 		return phase;
 	}
 
 private:
-	float phase{0.f};
-	float step{0.f};
+	uint32_t phase{0};
+	uint32_t step{0};
 };
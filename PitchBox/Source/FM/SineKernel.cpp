@@ -0,0 +1,22 @@
+#include "SineKernel.h"
+#include "../Core/Memory.h"
+
+// With the table backend every voice reads it three times a sample, so it goes where the callback reads fastest.
+// Otherwise only the chorus LFO (three reads every 16 samples) and the wavetable generator (at start up) read it,
+// which doesn't earn it a place in DTCM
+#if SINE_BACKEND == SINE_BACKEND_TABLE
+PITCHBOX_DTCM float sine::table[sine::TABLE_SIZE + 1];
+#else
+float sine::table[sine::TABLE_SIZE + 1];
+#endif
+
+namespace {
+	/// Fills the sine table before main() runs, so the audio callback never sees an empty table
+	struct TableInitializer {
+		TableInitializer(){
+			for(int i = 0; i <= sine::TABLE_SIZE; i++){
+				sine::table[i] = static_cast<float>(::sin(2.0 * 3.14159265358979323846 * i / sine::TABLE_SIZE));
+			}
+		}
+	} tableInitializer;
+}
@@ -0,0 +1,194 @@
+#pragma once
+#include "Lanes.h"
+#include <cmath>
+#include <cstdint>
+
+// Sine backends used by the FM voices, the VoiceBank and SinusoidSynth. Select one with SINE_BACKEND=table|poly|libm
+// in the Makefile. The polynomial is the default, the four lanes of the bank compute it without a gather.
+#define SINE_BACKEND_TABLE 0
+#define SINE_BACKEND_POLY 1
+#define SINE_BACKEND_LIBM 2
+
+#ifndef SINE_BACKEND
+#define SINE_BACKEND SINE_BACKEND_POLY
+#endif
+
+/// @brief Sine kernels working on phases expressed in cycles (1.0 == 2*pi), which is what the oscillators produce.
+/// Every kernel comes in two flavours: float phases (any finite value, wrapped by the kernel) and 32 bit
+/// fixed-point phases (the full uint32_t range is one cycle, so the phase wraps for free by overflow).
+namespace sine {
+	const float TWO_PI = 2.f * 3.14159265358979323846f;
+	const float INV_TWO_PI = 1.f / TWO_PI;
+
+	const int TABLE_BITS = 10;
+	const int TABLE_SIZE = 1 << TABLE_BITS;
+
+	const float FIXED_TO_CYCLES = 1.f / 4294967296.f; // 2^-32
+
+	/// One full sine cycle plus a guard point for the interpolation. Filled at start up in SineKernel.cpp
+	extern float table[TABLE_SIZE + 1];
+
+	/// @brief Wraps the phase into [0, 1]
+	inline float wrap(const float cycles){
+		return cycles - ::floorf(cycles);
+	}
+
+	/// @brief Linearly interpolated lookup in a 1024 point table.
+	/// Max abs error: (2*pi / 1024)^2 / 8 ~= 4.7e-6
+	inline float fromTable(const float cycles){
+		const float index = wrap(cycles) * TABLE_SIZE;
+		const int i = static_cast<int>(index);
+		const float frac = index - static_cast<float>(i);
+		const float* value = table + (i & (TABLE_SIZE - 1)); // wrap() can round up to exactly 1.0
+
+		return value[0] + frac * (value[1] - value[0]);
+	}
+
+	/// @brief Odd 9th order Taylor polynomial of sin(r) for r on the first quarter wave [0, pi/2], the one kernel of
+	/// every fromPoly() overload. Max abs error: (pi/2)^11 / 11! ~= 3.6e-6
+	template <typename T>
+	inline T quarterPoly(const T r){
+		const T r2 = r * r;
+		return r * (1.f + r2 * (-1.f / 6.f + r2 * (1.f / 120.f + r2 * (-1.f / 5040.f + r2 * (1.f / 362880.f)))));
+	}
+
+	/// @brief Folds a centered phase in [-0.5, 0.5) onto the first quarter [0, 0.25], the sine keeps its magnitude
+	inline float foldQuarter(const float x){
+		return 0.25f - ::fabsf(::fabsf(x) - 0.25f);
+	}
+
+	/// @brief Four lane version of foldQuarter(float)
+	inline lanes::float4 foldQuarter(const lanes::float4 x){
+		const auto quarter = lanes::broadcast(0.25f);
+		return quarter - lanes::abs(lanes::abs(x) - quarter);
+	}
+
+	/// @brief Polynomial sine of a centered phase in [-0.5, 0.5): the fold, the quarter wave and the sign of x
+	inline float fromCentered(const float x){
+		return ::copysignf(quarterPoly(TWO_PI * foldQuarter(x)), x);
+	}
+
+	/// @brief Four lane version of fromCentered(float)
+	inline lanes::float4 fromCentered(const lanes::float4 x){
+		return lanes::copySign(quarterPoly(lanes::broadcast(TWO_PI) * foldQuarter(x)), x);
+	}
+
+	/// @brief Odd 9th order Taylor polynomial evaluated on a quarter wave. Branchless, no memory access.
+	/// Max abs error: see quarterPoly()
+	inline float fromPoly(const float cycles){
+		return fromCentered(cycles - ::floorf(cycles + 0.5f));
+	}
+
+	/// @brief Four lane version of fromPoly(float). Same operations, same error bound.
+	inline lanes::float4 fromPoly(const lanes::float4 cycles){
+		return fromCentered(cycles - lanes::floor(cycles + lanes::broadcast(0.5f)));
+	}
+
+	/// @brief Single precision libm sine. Reference implementation, max abs error ~6e-7 (rounding of 2*pi*x)
+	inline float fromLibm(const float cycles){
+		return ::sinf(TWO_PI * wrap(cycles));
+	}
+
+	/// @brief Returns sin(2 * pi * cycles) using the backend selected at compile time
+	inline float fromPhase(const float cycles){
+	#if SINE_BACKEND == SINE_BACKEND_POLY
+		return fromPoly(cycles);
+	#elif SINE_BACKEND == SINE_BACKEND_LIBM
+		return fromLibm(cycles);
+	#else
+		return fromTable(cycles);
+	#endif
+	}
+
+	/// @brief Converts a phase in cycles to fixed point. Exact wrap for any finite value, not meant for the audio loop.
+	inline uint32_t toFixed(const float cycles){
+		const double wrapped = cycles - ::floor(static_cast<double>(cycles));
+		return static_cast<uint32_t>(static_cast<uint64_t>(wrapped * 4294967296.0));
+	}
+
+	/// @brief Fast conversion of a phase offset in cycles to fixed point, used for the FM modulation term.
+	/// Only valid for |cycles| < 0.99, which covers the modulation depth of all playable notes
+	/// (I1 + I2 < 0.8 cycles at note 36). Drops the lowest phase bit.
+	inline uint32_t offsetToFixed(const float cycles){
+		return static_cast<uint32_t>(static_cast<int32_t>(cycles * 2147483648.f)) << 1;
+	}
+
+	/// @brief Four lane version of offsetToFixed(float)
+	inline lanes::uint4 offsetToFixed(const lanes::float4 cycles){
+		return (lanes::uint4)__builtin_convertvector(cycles * 2147483648.f, lanes::int4) << 1;
+	}
+
+	/// @brief Fixed-point phase converted to cycles in [-0.5, 0.5)
+	inline float centered(const uint32_t phase){
+		return static_cast<float>(static_cast<int32_t>(phase)) * FIXED_TO_CYCLES;
+	}
+
+	/// @brief Table lookup addressed directly by the top bits of the phase, the remaining bits interpolate.
+	/// Same error bound as fromTable(float).
+	inline float fromTable(const uint32_t phase){
+		const int fractionBits = 32 - TABLE_BITS;
+		const float* value = table + (phase >> fractionBits);
+		const float frac = static_cast<float>(phase & ((1u << fractionBits) - 1)) * (1.f / (1u << fractionBits));
+
+		return value[0] + frac * (value[1] - value[0]);
+	}
+
+	/// @brief Four lane version of fromTable(uint32_t). The lanes read the table one by one, there is no gather
+	inline lanes::float4 fromTable(const lanes::uint4 phase){
+		const int fractionBits = 32 - TABLE_BITS;
+		const lanes::uint4 index = phase >> fractionBits;
+		const auto frac = __builtin_convertvector(phase & ((1u << fractionBits) - 1), lanes::float4) * (1.f / (1u << fractionBits));
+
+		lanes::float4 a, b;
+		for(int lane = 0; lane < lanes::WIDTH; lane++){
+			a[lane] = table[index[lane]];
+			b[lane] = table[index[lane] + 1];
+		}
+		return a + frac * (b - a);
+	}
+
+	/// @brief Polynomial sine of a fixed-point phase, the signed phase is already centered so no floor is needed
+	inline float fromPoly(const uint32_t phase){
+		return fromCentered(centered(phase));
+	}
+
+	/// @brief Four lane version of fromPoly(uint32_t)
+	inline lanes::float4 fromPoly(const lanes::uint4 phase){
+		return fromCentered(__builtin_convertvector((lanes::int4)phase, lanes::float4) * FIXED_TO_CYCLES);
+	}
+
+	/// @brief libm sine of a fixed-point phase, centered first so sinf gets |argument| <= pi. Reference implementation,
+	/// max abs error ~6e-7 like fromLibm(float)
+	inline float fromLibm(const uint32_t phase){
+		return ::sinf(TWO_PI * centered(phase));
+	}
+
+	/// @brief Four lane version of fromLibm(uint32_t), one sinf per lane
+	inline lanes::float4 fromLibm(const lanes::uint4 phase){
+		lanes::float4 value;
+		for(int lane = 0; lane < lanes::WIDTH; lane++) value[lane] = fromLibm(static_cast<uint32_t>(phase[lane]));
+		return value;
+	}
+
+	/// @brief Returns the sine of a fixed-point phase using the backend selected at compile time
+	inline float fromPhase(const uint32_t phase){
+	#if SINE_BACKEND == SINE_BACKEND_POLY
+		return fromPoly(phase);
+	#elif SINE_BACKEND == SINE_BACKEND_LIBM
+		return fromLibm(phase);
+	#else
+		return fromTable(phase);
+	#endif
+	}
+
+	/// @brief Four lane version of fromPhase(uint32_t), same backend
+	inline lanes::float4 fromPhase(const lanes::uint4 phase){
+	#if SINE_BACKEND == SINE_BACKEND_POLY
+		return fromPoly(phase);
+	#elif SINE_BACKEND == SINE_BACKEND_LIBM
+		return fromLibm(phase);
+	#else
+		return fromTable(phase);
+	#endif
+	}
+}
@@ -1,5 +1,7 @@
 #include "SinusoidSynth.h"
-#include "daisysp.h"
+#include "FmKernel.h"
+
+SinusoidSynth::SinusoidSynth(const harmony::Interval interval) : interval(interval) {}
 
 void SinusoidSynth::reset(const float startPhase){
 	carrierOsc.setPhase(startPhase);
@@ -8,52 +10,96 @@ void SinusoidSynth::reset(const float startPhase){
 }
 
 void SinusoidSynth::setCarrierFrequency(const float carrierFrequency){
-	const auto newFrequency =  calculateHarmonyFrequency(carrierFrequency, harmonyRatio);
-	if(abs(this->carrierFrequency - newFrequency) < 0.0001f) return;
+	const auto newFrequency = carrierFrequency * interval.ratio;
+	if(std::abs(this->carrierFrequency - newFrequency) < 0.0001f) return;
 
-	this->carrierFrequency = newFrequency;
-	update();
+	carrierNote = -1.f; // not set through a note, invalidate the cached note
+	setCoefficients(fm::fromFrequency(newFrequency));
+}
+
+void SinusoidSynth::setCarrierNote(const float note){
+	const auto newNote = note + interval.semitones;
+	if(std::abs(carrierNote - newNote) < 0.0001f) return;
+
+	carrierNote = newNote;
+	setCoefficients(fm::fromNote(newNote));
 }
 
 void SinusoidSynth::setSampleRate(const float sampleRate){
-	if(abs(this->sampleRate - sampleRate) < 0.0001f) return;
+	if(std::abs(this->sampleRate - sampleRate) < 0.0001f) return;
 
 	this->sampleRate = sampleRate;
+	envelope.setSampleRate(sampleRate);
 	update();
 }
 
 float SinusoidSynth::getNextValue(){
-	// e = A(t)sin[2*pi*fc*t + I1 * sin(2*pi*(fm1+S)*t) + I2 * sin(2*pi*(fm2+S)t)]
-	const auto sinM1 = sin(twoPi * m1Osc.getNextPhaseValue());
-	const auto sinM2 = sin(twoPi * m2Osc.getNextPhaseValue());
-	const auto output = sin(twoPi * carrierOsc.getNextPhaseValue() + I1 * sinM1 + I2 * sinM2);
+	if(envelope.isIdle()) return 0.f;
 
-	envelope += envelopeStep;
-	envelope = daisysp::fclamp(envelope, 0.f, 1.f);
-	
-	return output * envelope;
+	// e = A(t)sin[2*pi*fc*t + I1 * sin(2*pi*(fm1+S)*t) + I2 * sin(2*pi*(fm2+S)t)], see fm::sample
+	const auto m1Phase = m1Osc.getNextFixedPhase();
+	const auto m2Phase = m2Osc.getNextFixedPhase();
+	const auto output = fm::sample(carrierOsc.getNextFixedPhase(), m1Phase, m2Phase, I1, I2);
+
+	return output * envelope.getNextValue();
+}
+
+void SinusoidSynth::process(float* out, const size_t n, const float gain){
+	if(envelope.isIdle()) return; // fully decayed, nothing to add
+
+	// work on local copies so the phases and the envelope stay in registers for the whole block
+	auto carrierPhase = carrierOsc.getFixedPhase();
+	auto m1Phase = m1Osc.getFixedPhase();
+	auto m2Phase = m2Osc.getFixedPhase();
+	const auto carrierStep = carrierOsc.getFixedStep();
+	const auto m1Step = m1Osc.getFixedStep();
+	const auto m2Step = m2Osc.getFixedStep();
+	const auto i1 = I1;
+	const auto i2 = I2;
+	auto env = envelope.getValue();
+	const auto envStep = envelope.getStep();
+
+	for(size_t i = 0; i < n; i++){
+		// fixed-point phases wrap by overflow, same as Oscillator::getNextFixedPhase
+		carrierPhase += carrierStep;
+		m1Phase += m1Step;
+		m2Phase += m2Step;
+
+		const auto value = fm::sample(carrierPhase, m1Phase, m2Phase, i1, i2);
+
+		env = Envelope::clamp(env + envStep);
+
+		out[i] += value * env * gain;
+	}
+
+	carrierOsc.setFixedPhase(carrierPhase);
+	m1Osc.setFixedPhase(m1Phase);
+	m2Osc.setFixedPhase(m2Phase);
+	envelope.setValue(env);
+}
+
+void SinusoidSynth::setCoefficients(const fm::Coefficients& coefficients){
+	carrierFrequency = coefficients.frequency;
+	I1 = coefficients.I1;
+	I2 = coefficients.I2;
+	update();
 }
 
 void SinusoidSynth::update(){
-	const auto lnfc = log(carrierFrequency);
+	if(sampleRate <= 0.f) return; // steps are set once the sample rate is known
 
-	const auto S = carrierFrequency * 0.005;					// S = fc / 200;
-	I1 = 17 * (8 - lnfc) / (lnfc * lnfc);						// I1 = 17*(8-ln(fc)) / (ln(fc))^2;
-	I2 = 20 * (8 - lnfc) / carrierFrequency; 					// I2 = 20*(8-ln(fc)) / fc;
+	const auto S = carrierFrequency * fm::S_RATIO;				// S = fc / 200;
 
 	carrierOsc.setStep(carrierFrequency / sampleRate);			// fc:fm1:fm2 == 1:1:4
 	m1Osc.setStep((carrierFrequency + S) / sampleRate);			// fm1 + S
 	m2Osc.setStep((carrierFrequency * 4.f + S) / sampleRate);	// fm2 + S
 }
 
-float SinusoidSynth::calculateHarmonyFrequency(const float baseFrequency, const HarmonyRatio& ratio){
-	return baseFrequency * ratio.numerator / ratio.denominator;
-}
-
 void SinusoidSynth::startAttackPhase(const float miliseconds){
-	envelopeStep = 1 / (miliseconds * 0.001 * sampleRate);
+	if(envelope.isIdle()) reset(0.f); // a silent voice starts from a zero crossing
+	envelope.startAttackPhase(miliseconds);
 }
 
 void SinusoidSynth::startDecayPhase(const float miliseconds){
-	envelopeStep = -1 / (miliseconds * 0.001 * sampleRate);
+	envelope.startDecayPhase(miliseconds);
 }
\ No newline at end of file
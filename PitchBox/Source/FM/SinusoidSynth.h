@@ -1,18 +1,18 @@
 #pragma once
 #include "Oscillator.h"
+#include "Envelope.h"
+#include "FmCoefficients.h"
+#include "Harmony.h"
 #include <cmath>
+#include <cstddef>
 
 /// @brief FrequencyModulation based synthesizer. Implementation based on the paper
 /// "The Simulation of Natural Instrument Tones using Frequency Modulation with a Complex Modulating Wave
 /// by  Bill Schottstaedt
 class SinusoidSynth {
 public:
-	struct HarmonyRatio {
-		float numerator;
-		float denominator;
-	};
-
-	SinusoidSynth(HarmonyRatio ratio = {1.f, 1.f}) : harmonyRatio(ratio) {};
+	/// @param interval Interval to the base pitch, see harmony::
+	SinusoidSynth(const harmony::Interval interval = harmony::UNISON);
 	~SinusoidSynth() = default;
 
 	/// @brief Resets Synth's internal oscillator phases to given value
@@ -23,6 +23,11 @@ public:
 	/// @param carrierFrequency The new carrier frequency
 	void setCarrierFrequency(const float carrierFrequency);
 
+	/// @brief Sets the base carrier pitch as a fractional note number. Cheaper than setCarrierFrequency(),
+	/// the FM coefficients are looked up in the precomputed fm:: table instead of being computed.
+	/// @param note The new carrier note, the harmony ratio is added on top of it
+	void setCarrierNote(const float note);
+
 	/// @brief Sets the sample rate and updates internal values accordingly
 	/// @param sampleRate The new sample rete
 	void setSampleRate(const float sampleRate);
@@ -31,10 +36,18 @@ public:
 	/// @return Next sample
 	float getNextValue();
 
+	/// @brief Renders a whole block and adds it, scaled by gain, to the given buffer.
+	/// Produces the same samples as calling getNextValue() n times.
+	/// @param out Buffer the synthesised block is accumulated into
+	/// @param n Number of samples to render
+	/// @param gain Gain applied to the synthesised samples before accumulation
+	void process(float* out, const size_t n, const float gain);
+
 	/// @brief Returns current value of carrier's phase
 	float getCarrierPhase() const { return carrierOsc.getPhase(); }
 
-	/// @brief Tells synth that it is in attack phase and should scale the output for x miliseconds according to internal envolpe
+	/// @brief Tells synth that it is in attack phase and should scale the output for x miliseconds according to internal envolpe.
+	/// A silent synth restarts its oscillators from phase 0.
 	/// @param miliseconds The length of the attack phase
 	void startAttackPhase(const float miliseconds = 10);
 
@@ -42,25 +55,32 @@ public:
 	/// @param miliseconds The length of the decay phase
 	void startDecayPhase(const float miliseconds = 10);
 
+	/// @brief Returns the current state of the internal envelope
+	Envelope::State getEnvelopeState() const { return envelope.getState(); }
+
+	/// @brief True when the synth has fully decayed and produces silence until the next attack phase.
+	/// getNextValue() and process() do no work in this state.
+	bool isSilent() const { return envelope.isIdle(); }
+
 private:
-	/// Updates internal variables and oscillators
+	/// Stores new carrier coefficients and updates the oscillators
+	void setCoefficients(const fm::Coefficients& coefficients);
+
+	/// Updates the oscillator steps from the carrier frequency and the sample rate
 	void update();
-	static float calculateHarmonyFrequency(const float baseFrequency, const HarmonyRatio& ratio);
 
-	HarmonyRatio harmonyRatio;
+	harmony::Interval interval;
 
 	Oscillator carrierOsc;
 	Oscillator m1Osc;
 	Oscillator m2Osc;
 
-	float I1{0.f};
+	float I1{0.f}; // modulation indices, in cycles
 	float I2{0.f};
 
 	float carrierFrequency{0.f};
+	float carrierNote{-1.f};
 	float sampleRate{0.f};
 
-	float envelope{1.f};
-	float envelopeStep{0.f};
-
-	const float twoPi = 2.f * 3.14159265358979323846f;
+	Envelope envelope;
 };
@@ -0,0 +1,195 @@
+#include "VoiceBank.h"
+#include "FmKernel.h"
+#include <cmath>
+#include <utility>
+
+namespace {
+	/// Intervals of the voices to the main pitch, in VoiceBank::Voice order. Computed by the compiler
+	constexpr harmony::Interval HARMONIES[VoiceBank::NUM_VOICES] = {
+		harmony::UNISON,		// main
+		harmony::FIFTH,
+		harmony::FOURTH,
+		harmony::MAJOR_THIRD,
+		harmony::MINOR_THIRD,
+		harmony::OCTAVE
+	};
+}
+
+harmony::Interval VoiceBank::getHarmony(const Voice voice){
+	return HARMONIES[voice];
+}
+
+VoiceBank::VoiceBank(){
+	for(int lane = 0; lane < NUM_LANES; lane++){
+		voiceOf[lane] = lane < NUM_VOICES ? lane : NUM_VOICES; // padding lanes hold no voice
+		if(lane < NUM_VOICES) laneOf[lane] = lane;
+
+		ratio[lane] = lane < NUM_VOICES ? HARMONIES[lane].ratio : 0.f;
+		interval[lane] = lane < NUM_VOICES ? HARMONIES[lane].semitones : 0.f;
+		carrierFrequency[lane] = 0.f;
+		carrierNote[lane] = -1.f;
+
+		carrierPhase[lane] = m1Phase[lane] = m2Phase[lane] = 0;
+		carrierStep[lane] = m1Step[lane] = m2Step[lane] = 0;
+		I1[lane] = I2[lane] = 0.f;
+
+		// the main voice is always on, the intervals start silent
+		state[lane] = lane == MAIN ? Envelope::State::SUSTAIN : Envelope::State::IDLE;
+		envelope[lane] = lane == MAIN ? 1.f : 0.f;
+		envelopeStep[lane] = 0.f;
+		gains[lane] = 0.f;
+	}
+
+	activeLanes = 1;
+}
+
+void VoiceBank::reset(const float startPhase){
+	const auto phase = sine::toFixed(startPhase);
+	for(int lane = 0; lane < NUM_LANES; lane++){
+		carrierPhase[lane] = m1Phase[lane] = m2Phase[lane] = phase;
+	}
+}
+
+void VoiceBank::setSampleRate(const float sampleRate){
+	if(std::abs(this->sampleRate - sampleRate) < 0.0001f) return;
+
+	this->sampleRate = sampleRate;
+	for(int lane = 0; lane < NUM_LANES; lane++) update(lane);
+}
+
+void VoiceBank::setCarrierFrequency(const Voice voice, const float baseFrequency){
+	const auto lane = laneOf[voice];
+	const auto newFrequency = baseFrequency * ratio[lane];
+	if(std::abs(carrierFrequency[lane] - newFrequency) < 0.0001f) return;
+
+	carrierNote[lane] = -1.f; // not set through a note, invalidate the cached note
+	setCoefficients(lane, fm::fromFrequency(newFrequency));
+}
+
+void VoiceBank::setCarrierNote(const Voice voice, const float baseNote){
+	const auto lane = laneOf[voice];
+	const auto newNote = baseNote + interval[lane];
+	if(std::abs(carrierNote[lane] - newNote) < 0.0001f) return;
+
+	carrierNote[lane] = newNote;
+	setCoefficients(lane, fm::fromNote(newNote));
+}
+
+void VoiceBank::startAttackPhase(const Voice voice, const float miliseconds){
+	auto lane = laneOf[voice];
+	if(lane >= activeLanes){ // wake the voice up by moving it into the first free active lane
+		swapLanes(lane, activeLanes);
+		lane = activeLanes++;
+	}
+	if(state[lane] == Envelope::State::IDLE){ // a silent voice starts from a zero crossing
+		carrierPhase[lane] = m1Phase[lane] = m2Phase[lane] = 0;
+	}
+
+	envelopeStep[lane] = 1 / (miliseconds * 0.001f * sampleRate);
+	state[lane] = Envelope::State::ATTACK;
+}
+
+void VoiceBank::startDecayPhase(const Voice voice, const float miliseconds){
+	const auto lane = laneOf[voice];
+
+	envelopeStep[lane] = -1 / (miliseconds * 0.001f * sampleRate);
+	state[lane] = envelope[lane] > 0.f ? Envelope::State::RELEASE : Envelope::State::IDLE;
+}
+
+void VoiceBank::swapLanes(const int a, const int b){
+	if(a == b) return;
+
+	std::swap(state[a], state[b]);
+	std::swap(ratio[a], ratio[b]);
+	std::swap(interval[a], interval[b]);
+	std::swap(carrierFrequency[a], carrierFrequency[b]);
+	std::swap(carrierNote[a], carrierNote[b]);
+	std::swap(carrierPhase[a], carrierPhase[b]);
+	std::swap(m1Phase[a], m1Phase[b]);
+	std::swap(m2Phase[a], m2Phase[b]);
+	std::swap(carrierStep[a], carrierStep[b]);
+	std::swap(m1Step[a], m1Step[b]);
+	std::swap(m2Step[a], m2Step[b]);
+	std::swap(I1[a], I1[b]);
+	std::swap(I2[a], I2[b]);
+	std::swap(envelope[a], envelope[b]);
+	std::swap(envelopeStep[a], envelopeStep[b]);
+	std::swap(gains[a], gains[b]);
+
+	std::swap(voiceOf[a], voiceOf[b]);
+	if(voiceOf[a] < NUM_VOICES) laneOf[voiceOf[a]] = a;
+	if(voiceOf[b] < NUM_VOICES) laneOf[voiceOf[b]] = b;
+}
+
+void VoiceBank::retireIdleVoices(){
+	// walk backwards so the lane swapped in from the end has already been checked
+	for(int lane = activeLanes - 1; lane >= 0; lane--){
+		if(state[lane] != Envelope::State::IDLE) continue;
+
+		swapLanes(lane, --activeLanes);
+	}
+}
+
+void VoiceBank::setCoefficients(const int lane, const fm::Coefficients& coefficients){
+	carrierFrequency[lane] = coefficients.frequency;
+	I1[lane] = coefficients.I1;
+	I2[lane] = coefficients.I2;
+	update(lane);
+}
+
+void VoiceBank::update(const int lane){
+	const auto fc = carrierFrequency[lane];
+	if(fc <= 0.f || sampleRate <= 0.f) return; // not played yet
+
+	// same oscillator ratios as SinusoidSynth::update()
+	const auto S = fc * fm::S_RATIO;
+
+	carrierStep[lane] = sine::toFixed(fc / sampleRate);
+	m1Step[lane] = sine::toFixed((fc + S) / sampleRate);
+	m2Step[lane] = sine::toFixed((fc * 4.f + S) / sampleRate);
+}
+
+void VoiceBank::process(float* out, const size_t n){
+	const auto one = lanes::broadcast(1.f);
+	const auto zero = lanes::broadcast(0.f);
+
+	retireIdleVoices();
+
+	// only the lane groups holding active voices are rendered, the rest of the last group is silent
+	for(int lane = 0; lane < activeLanes; lane += lanes::WIDTH){
+		// the state of four voices lives in registers for the whole block
+		auto cPhase = lanes::load(carrierPhase + lane);
+		auto mod1Phase = lanes::load(m1Phase + lane);
+		auto mod2Phase = lanes::load(m2Phase + lane);
+		auto env = lanes::load(envelope + lane);
+		const auto cStep = lanes::load(carrierStep + lane);
+		const auto mod1Step = lanes::load(m1Step + lane);
+		const auto mod2Step = lanes::load(m2Step + lane);
+		const auto i1 = lanes::load(I1 + lane);
+		const auto i2 = lanes::load(I2 + lane);
+		const auto envStep = lanes::load(envelopeStep + lane);
+		const auto gain = lanes::load(gains + lane);
+
+		for(size_t i = 0; i < n; i++){
+			// fixed-point phases wrap by overflow
+			cPhase += cStep;
+			mod1Phase += mod1Step;
+			mod2Phase += mod2Step;
+
+			const auto value = fm::sample(cPhase, mod1Phase, mod2Phase, i1, i2);
+
+			env = lanes::min(lanes::max(env + envStep, zero), one);
+
+			out[i] += lanes::sum(value * env * gain);
+		}
+
+		lanes::store(carrierPhase + lane, cPhase);
+		lanes::store(m1Phase + lane, mod1Phase);
+		lanes::store(m2Phase + lane, mod2Phase);
+		lanes::store(envelope + lane, env);
+	}
+
+	for(int lane = 0; lane < activeLanes; lane++){
+		state[lane] = Envelope::nextState(state[lane], envelope[lane]);
+	}
+}
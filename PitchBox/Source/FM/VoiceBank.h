@@ -0,0 +1,113 @@
+#pragma once
+#include "Lanes.h"
+#include "Envelope.h"
+#include "FmCoefficients.h"
+#include "Harmony.h"
+#include <cstddef>
+#include <cstdint>
+
+/// @brief All voices of the instrument (main synth and the interval synths) in one structure-of-arrays bank.
+/// Every voice runs the same FM algorithm as SinusoidSynth, but the voices are rendered together,
+/// four lanes at a time. The phases, steps, modulation indices, envelopes and gains of all voices are stored
+/// as contiguous arrays, one lane per voice.
+/// Voices which are not idle are kept packed at the front of the lanes, so only the lane groups holding
+/// sounding voices are rendered. Voices are addressed by Voice, the lane a voice lives in changes over time.
+class VoiceBank {
+public:
+	enum Voice {
+		MAIN = 0,
+		FIFTH,
+		FOURTH,
+		THIRD,
+		THIRD_MINOR,
+		OCTAVE,
+		NUM_VOICES
+	};
+
+	/// Number of lanes, NUM_VOICES rounded up to a multiple of the lane width. Padding lanes stay silent
+	static const int NUM_LANES = (NUM_VOICES + lanes::WIDTH - 1) / lanes::WIDTH * lanes::WIDTH;
+
+	VoiceBank();
+	~VoiceBank() = default;
+
+	/// @brief Returns the interval of a voice to the main pitch, both as a ratio and in semitones
+	static harmony::Interval getHarmony(const Voice voice);
+
+	/// @brief Returns the carrier ratio of a voice relative to the main pitch
+	static float getHarmonyRatio(const Voice voice) { return getHarmony(voice).ratio; }
+
+	/// @brief Resets all internal oscillator phases to given value
+	/// @param startPhase Internal oscillator phases will be set to this value
+	void reset(const float startPhase);
+
+	/// @brief Sets the sample rate of all voices and updates internal values accordingly
+	/// @param sampleRate The new sample rate
+	void setSampleRate(const float sampleRate);
+
+	/// @brief Sets the base carrier frequency of a voice. The voice's harmony ratio is applied on top of it.
+	/// @param voice The voice to update
+	/// @param baseFrequency The frequency of the main voice
+	void setCarrierFrequency(const Voice voice, const float baseFrequency);
+
+	/// @brief Sets the base carrier pitch of a voice as a fractional note number. The voice's interval is
+	/// added on top of it and the FM coefficients are looked up in the fm:: table.
+	/// @param voice The voice to update
+	/// @param baseNote The note of the main voice
+	void setCarrierNote(const Voice voice, const float baseNote);
+
+	/// @brief Sets the gain the voice is mixed with
+	void setGain(const Voice voice, const float gain) { gains[laneOf[voice]] = gain; }
+
+	/// @brief Starts the attack phase of a voice, see SinusoidSynth::startAttackPhase
+	void startAttackPhase(const Voice voice, const float miliseconds = 10);
+
+	/// @brief Starts the decay phase of a voice, see SinusoidSynth::startDecayPhase
+	void startDecayPhase(const Voice voice, const float miliseconds = 10);
+
+	/// @brief True when the voice has fully decayed and is not rendered at all
+	bool isSilent(const Voice voice) const { return state[laneOf[voice]] == Envelope::State::IDLE; }
+
+	/// @brief Number of voices which are currently rendered
+	int getActiveVoices() const { return activeLanes; }
+
+	/// @brief Renders a block of all voices, each scaled by its gain, and adds the mix to the given buffer
+	/// @param out Buffer the mix is accumulated into
+	/// @param n Number of samples to render
+	void process(float* out, const size_t n);
+
+private:
+	/// Stores new carrier coefficients of the voice in given lane and updates its oscillator steps
+	void setCoefficients(const int lane, const fm::Coefficients& coefficients);
+
+	/// Updates the oscillator steps of the voice in given lane
+	void update(const int lane);
+
+	/// Swaps the complete state of two lanes and updates the voice <-> lane mapping
+	void swapLanes(const int a, const int b);
+
+	/// Moves idle voices behind the active ones
+	void retireIdleVoices();
+
+	int laneOf[NUM_VOICES];
+	int voiceOf[NUM_LANES];
+	int activeLanes{0}; // lanes [0, activeLanes) hold voices which are not idle
+
+	Envelope::State state[NUM_LANES];
+	float ratio[NUM_LANES];
+	float interval[NUM_LANES]; // ratio in semitones
+	float carrierFrequency[NUM_LANES];
+	float carrierNote[NUM_LANES];
+	float sampleRate{0.f};
+
+	alignas(16) uint32_t carrierPhase[NUM_LANES]; // fixed point, see Oscillator
+	alignas(16) uint32_t m1Phase[NUM_LANES];
+	alignas(16) uint32_t m2Phase[NUM_LANES];
+	alignas(16) uint32_t carrierStep[NUM_LANES];
+	alignas(16) uint32_t m1Step[NUM_LANES];
+	alignas(16) uint32_t m2Step[NUM_LANES];
+	alignas(16) float I1[NUM_LANES]; // modulation indices, in cycles
+	alignas(16) float I2[NUM_LANES];
+	alignas(16) float envelope[NUM_LANES];
+	alignas(16) float envelopeStep[NUM_LANES];
+	alignas(16) float gains[NUM_LANES];
+};
@@ -0,0 +1,96 @@
+#include "WavetableSynth.h"
+#include <cmath>
+
+WavetableSynth::WavetableSynth(const harmony::Interval interval, Envelope::State initialState) :
+	harmonySemitones(interval.semitones),
+	envelope(initialState) {}
+
+void WavetableSynth::reset(const float startPhase){
+	carrierOsc.setPhase(startPhase);
+}
+
+void WavetableSynth::setCarrierFrequency(const float carrierFrequency){
+	if(carrierFrequency <= 0.f) return;
+	setCarrierNote(57.f + 12.f * log2f(carrierFrequency / 440.f)); // the tables are organised by note
+}
+
+void WavetableSynth::setCarrierNote(const float note){
+	const auto newNote = note + harmonySemitones;
+	if(std::abs(carrierNote - newNote) < 0.0001f) return;
+
+	carrierNote = newNote;
+	carrierFrequency = fm::fromNote(newNote).frequency;
+	update();
+}
+
+void WavetableSynth::setSampleRate(const float sampleRate){
+	if(std::abs(this->sampleRate - sampleRate) < 0.0001f) return;
+
+	this->sampleRate = sampleRate;
+	envelope.setSampleRate(sampleRate);
+	update();
+}
+
+float WavetableSynth::getNextValue(){
+	if(envelope.isIdle()) return 0.f;
+
+	return wavetable::read(table, carrierOsc.getNextFixedPhase()) * envelope.getNextValue();
+}
+
+void WavetableSynth::process(float* out, const size_t n, const float gain){
+	if(envelope.isIdle()) return; // fully decayed, nothing to add
+
+	auto phase = carrierOsc.getFixedPhase();
+	const auto step = carrierOsc.getFixedStep();
+	const auto* cycle = table;
+	auto env = envelope.getValue();
+	const auto envStep = envelope.getStep();
+
+	for(size_t i = 0; i < n; i++){
+		phase += step;
+		env = Envelope::clamp(env + envStep);
+
+		out[i] += wavetable::read(cycle, phase) * env * gain;
+	}
+
+	carrierOsc.setFixedPhase(phase);
+	envelope.setValue(env);
+}
+
+void WavetableSynth::update(){
+	if(sampleRate <= 0.f || carrierFrequency <= 0.f) return;
+
+	table = wavetable::tables[wavetable::regionFromNote(carrierNote)];
+	carrierOsc.setStep(carrierFrequency / sampleRate);
+}
+
+void WavetableSynth::startAttackPhase(const float miliseconds){
+	if(envelope.isIdle()) reset(0.f); // a silent voice starts from the beginning of the cycle
+	envelope.startAttackPhase(miliseconds);
+}
+
+void WavetableSynth::startDecayPhase(const float miliseconds){
+	envelope.startDecayPhase(miliseconds);
+}
+
+WavetableBank::WavetableBank(){
+	for(int voice = 0; voice < VoiceBank::NUM_VOICES; voice++){
+		const auto state = voice == VoiceBank::MAIN ? Envelope::State::SUSTAIN : Envelope::State::IDLE;
+		voices[voice] = WavetableSynth(VoiceBank::getHarmony(static_cast<Voice>(voice)), state);
+		gains[voice] = 0.f;
+	}
+}
+
+void WavetableBank::setSampleRate(const float sampleRate){
+	if(std::abs(this->sampleRate - sampleRate) < 0.0001f) return;
+
+	this->sampleRate = sampleRate;
+	wavetable::generate(sampleRate);
+	for(auto& voice : voices) voice.setSampleRate(sampleRate);
+}
+
+void WavetableBank::process(float* out, const size_t n){
+	for(int voice = 0; voice < VoiceBank::NUM_VOICES; voice++){
+		voices[voice].process(out, n, gains[voice]); // returns right away for silent voices
+	}
+}
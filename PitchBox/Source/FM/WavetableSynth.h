@@ -0,0 +1,92 @@
+#pragma once
+#include "Oscillator.h"
+#include "Envelope.h"
+#include "VoiceBank.h"
+#include "Wavetables.h"
+#include <cstddef>
+
+/// @brief Wavetable version of SinusoidSynth with the same interface. Plays the pre-rendered FM timbre from the
+/// wavetable:: tables with one table read per sample instead of three sines. wavetable::generate() has to be
+/// called before the synth is played.
+class WavetableSynth {
+public:
+	/// @param interval Interval to the base pitch, see harmony::
+	/// @param initialState State of the envelope, interval voices start IDLE
+	WavetableSynth(const harmony::Interval interval = harmony::UNISON,
+		Envelope::State initialState = Envelope::State::SUSTAIN);
+	~WavetableSynth() = default;
+
+	/// @brief Resets Synth's internal oscillator phase to given value
+	void reset(const float startPhase);
+
+	/// @brief Sets the base carrier frequency, see SinusoidSynth::setCarrierFrequency
+	void setCarrierFrequency(const float carrierFrequency);
+
+	/// @brief Sets the base carrier pitch as a fractional note number, see SinusoidSynth::setCarrierNote
+	void setCarrierNote(const float note);
+
+	/// @brief Sets the sample rate and updates internal values accordingly
+	void setSampleRate(const float sampleRate);
+
+	/// @brief Returns current synthesised value. This function is meant to be run every sample during processing.
+	float getNextValue();
+
+	/// @brief Renders a block and adds it, scaled by gain, to the given buffer. See SinusoidSynth::process
+	void process(float* out, const size_t n, const float gain);
+
+	/// @brief Returns current value of carrier's phase
+	float getCarrierPhase() const { return carrierOsc.getPhase(); }
+
+	/// @brief Starts the attack phase, see SinusoidSynth::startAttackPhase
+	void startAttackPhase(const float miliseconds = 10);
+
+	/// @brief Starts the decay phase, see SinusoidSynth::startDecayPhase
+	void startDecayPhase(const float miliseconds = 10);
+
+	Envelope::State getEnvelopeState() const { return envelope.getState(); }
+	bool isSilent() const { return envelope.isIdle(); }
+
+private:
+	/// Picks the table of the current note and updates the oscillator step
+	void update();
+
+	float harmonySemitones; // the interval to the base pitch
+
+	Oscillator carrierOsc;
+	const float* table{wavetable::tables[0]};
+
+	float carrierNote{-1.f};
+	float carrierFrequency{0.f};
+	float sampleRate{0.f};
+
+	Envelope envelope;
+};
+
+/// @brief Drop-in replacement of VoiceBank built from WavetableSynth voices. Selected with ENGINE=wavetable.
+class WavetableBank {
+public:
+	typedef VoiceBank::Voice Voice;
+
+	WavetableBank();
+	~WavetableBank() = default;
+
+	/// @brief Sets the sample rate of all voices and regenerates the wavetables for it
+	void setSampleRate(const float sampleRate);
+
+	void setCarrierFrequency(const Voice voice, const float baseFrequency) { voices[voice].setCarrierFrequency(baseFrequency); }
+	void setCarrierNote(const Voice voice, const float baseNote) { voices[voice].setCarrierNote(baseNote); }
+	void setGain(const Voice voice, const float gain) { gains[voice] = gain; }
+
+	void startAttackPhase(const Voice voice, const float miliseconds = 10) { voices[voice].startAttackPhase(miliseconds); }
+	void startDecayPhase(const Voice voice, const float miliseconds = 10) { voices[voice].startDecayPhase(miliseconds); }
+
+	bool isSilent(const Voice voice) const { return voices[voice].isSilent(); }
+
+	/// @brief Renders a block of all sounding voices, each scaled by its gain, and adds the mix to the given buffer
+	void process(float* out, const size_t n);
+
+private:
+	WavetableSynth voices[VoiceBank::NUM_VOICES];
+	float gains[VoiceBank::NUM_VOICES];
+	float sampleRate{0.f};
+};
@@ -0,0 +1,70 @@
+#include "Wavetables.h"
+#include "FmKernel.h"
+#include <cmath>
+
+float wavetable::tables[wavetable::NUM_REGIONS][wavetable::TABLE_SIZE + 1];
+
+static_assert(wavetable::TABLE_SIZE == sine::TABLE_SIZE, "the generator reuses the sine table as its DFT basis");
+
+namespace {
+	float sinOfIndex(const int index){ return sine::table[index & (sine::TABLE_SIZE - 1)]; }
+	float cosOfIndex(const int index){ return sine::table[(index + sine::TABLE_SIZE / 4) & (sine::TABLE_SIZE - 1)]; }
+
+	/// One cycle of the FM voice at given note, with S = 0 so it is exactly periodic. The oscillators step by one
+	/// table index per sample, the fixed-point phases of the carrier and the 1:1:4 modulators wrap exactly at the
+	/// end of the cycle
+	void renderCycle(float* cycle, const float note){
+		const auto coefficients = fm::fromNote(note);
+		const uint32_t step = 1u << (32 - wavetable::TABLE_BITS);
+
+		for(int k = 0; k < wavetable::TABLE_SIZE; k++){
+			const uint32_t phase = static_cast<uint32_t>(k) * step;
+			cycle[k] = fm::sample(phase, phase, 4 * phase, coefficients.I1, coefficients.I2);
+		}
+	}
+}
+
+void wavetable::generate(const float sampleRate){
+	static float cycle[TABLE_SIZE];
+	static float cosine[MAX_HARMONIC + 1];
+	static float sinus[MAX_HARMONIC + 1];
+
+	for(int region = 0; region < NUM_REGIONS; region++){
+		const float note = fm::MIN_NOTE + region * NOTES_PER_REGION;
+		renderCycle(cycle, note);
+
+		// analyse the harmonics of the cycle (plain DFT, the basis comes from the sine table)
+		for(int h = 0; h <= MAX_HARMONIC; h++){
+			float a = 0.f, b = 0.f;
+			for(int k = 0; k < TABLE_SIZE; k++){
+				a += cycle[k] * cosOfIndex(h * k);
+				b += cycle[k] * sinOfIndex(h * k);
+			}
+			const float scale = h == 0 ? 1.f / TABLE_SIZE : 2.f / TABLE_SIZE;
+			cosine[h] = a * scale;
+			sinus[h] = b * scale;
+		}
+
+		// keep only the harmonics which stay below Nyquist at the highest note of the region
+		const float topFrequency = fm::frequencyFromNote(note + NOTES_PER_REGION * 0.5f);
+		int harmonics = static_cast<int>(0.5f * sampleRate / topFrequency);
+		if(harmonics > MAX_HARMONIC) harmonics = MAX_HARMONIC;
+
+		float* table = tables[region];
+		float energy = 0.f;
+		for(int k = 0; k < TABLE_SIZE; k++){
+			float value = cosine[0];
+			for(int h = 1; h <= harmonics; h++){
+				value += cosine[h] * cosOfIndex(h * k) + sinus[h] * sinOfIndex(h * k);
+			}
+			table[k] = value;
+			energy += value * value;
+		}
+
+		// with S the relative phase of carrier and modulators drifts and the FM voice averages out at the RMS of
+		// a sine, a frozen cycle can be up to ~2 dB quieter, so every table is normalised to that loudness
+		const float gain = sqrtf(0.5f * TABLE_SIZE / energy);
+		for(int k = 0; k < TABLE_SIZE; k++) table[k] *= gain;
+		table[TABLE_SIZE] = table[0];
+	}
+}
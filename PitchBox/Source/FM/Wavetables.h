@@ -0,0 +1,42 @@
+#pragma once
+#include "FmCoefficients.h"
+#include <cstdint>
+
+/// @brief Single-cycle wavetables holding the FM timbre of SinusoidSynth, one band-limited table per note region.
+/// The modulation indices only depend on the carrier and the modulators are harmonic (1:1:4), so one cycle of the
+/// FM output at a region's centre note is a periodic waveform which can be pre-rendered. The small S detune of the
+/// modulators is not periodic and is left out, so the slow beating of SinusoidSynth is not reproduced.
+namespace wavetable {
+	const int TABLE_BITS = 10;
+	const int TABLE_SIZE = 1 << TABLE_BITS;
+
+	const int NOTES_PER_REGION = 3;
+	const int NUM_REGIONS = (fm::MAX_NOTE - fm::MIN_NOTE) / NOTES_PER_REGION + 1;
+
+	/// Highest harmonic analysed. The FM spectrum of all playable notes is more than 80 dB down above it
+	const int MAX_HARMONIC = 64;
+
+	/// One cycle per region plus a guard point for the interpolation. Filled by generate()
+	extern float tables[NUM_REGIONS][TABLE_SIZE + 1];
+
+	/// @brief Renders all tables from the FM algorithm and band-limits each of them so the highest note of its
+	/// region stays below Nyquist. Has to run before any WavetableSynth is played and whenever the sample rate
+	/// changes. Takes a few milliseconds, not meant to be called from the audio callback.
+	/// @param sampleRate The sample rate the tables will be played at
+	void generate(const float sampleRate);
+
+	/// @brief Returns the region a (fractional) note is played from
+	inline int regionFromNote(const float note){
+		const int region = static_cast<int>((note - fm::MIN_NOTE) / NOTES_PER_REGION + 0.5f);
+		return region < 0 ? 0 : (region >= NUM_REGIONS ? NUM_REGIONS - 1 : region);
+	}
+
+	/// @brief Linearly interpolated read of a table, addressed by a fixed-point phase like sine::fromTable
+	inline float read(const float* table, const uint32_t phase){
+		const int fractionBits = 32 - TABLE_BITS;
+		const float* value = table + (phase >> fractionBits);
+		const float frac = static_cast<float>(phase & ((1u << fractionBits) - 1)) * (1.f / (1u << fractionBits));
+
+		return value[0] + frac * (value[1] - value[0]);
+	}
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <math.h>
+
+namespace mapping {
+    /// @brief Equal loudness compensation over the whole audible range, the 80 phon contour of `Mapping Test/script.py`
+    /// (https://github.com/andrewjhunt/equal-loudness). The contour is given in third octaves, linear in Hz between
+    /// them. It's resampled at compile time to a table uniform in note numbers, i.e. in log-frequency, so a lookup is
+    /// one interpolation instead of a search through the bands.
+    namespace loudness {
+        const int NUM_BANDS = 32;
+        constexpr float FREQUENCIES[NUM_BANDS] = { 0,      20,     25,     31.5,   40,     50,     63,     80,     100,
+            125,    160,    200,    250,    315,    400,    500,    630,    800,    1000,   1250,   1600,   2000,
+            2500,   3150,   4000,   5000,   6300,   8000,   10000,  12500,  16000,  20000 }; // Hz
+        constexpr float LEVELS[NUM_BANDS] = { 145.0,  118.99, 114.23, 109.65, 105.34, 101.72, 98.36,  95.17,  92.48,
+            90.09,  87.82,  85.92,  84.31,  82.89,  81.68,  80.86,  80.17,  79.67,  80.01,  82.48,  83.74,  80.59,
+            77.88,  77.07,  78.31,  81.62,  86.81,  91.41,  91.74,  85.41,  84.67,  118.95 }; // dB SPL
+        const float REFERENCE_LEVEL = 80.f; // dB, gain 1.0
+
+        const int MIN_NOTE = 0; // C0, 16 Hz
+        const int MAX_NOTE = 124; // E10, 21 kHz
+        const int STEPS_PER_NOTE = 4;
+        const int TABLE_SIZE = (MAX_NOTE - MIN_NOTE) * STEPS_PER_NOTE + 1;
+
+        /// 2^x, constexpr (std::exp2 isn't). Splits off the integer part, the rest is a Taylor series of e^(x ln 2)
+        constexpr double exp2(const double x) {
+            int whole = static_cast<int>(x);
+            if (whole > x) whole--;
+
+            const double y = (x - whole) * 0.69314718055994530942;
+            double sum = 1.0, term = 1.0;
+            for (int i = 1; i < 24; i++) {
+                term *= y / i;
+                sum += term;
+            }
+
+            for (; whole > 0; whole--) sum *= 2.0;
+            for (; whole < 0; whole++) sum *= 0.5;
+            return sum;
+        }
+
+        /// The contour at given frequency as script.py interpolates it, the last band continues above 20 kHz
+        constexpr float levelAt(const double frequency) {
+            for (int i = 0; i < NUM_BANDS - 1; i++) {
+                if (frequency >= FREQUENCIES[i] && frequency < FREQUENCIES[i + 1]) {
+                    const double slope = (LEVELS[i + 1] - LEVELS[i]) / (FREQUENCIES[i + 1] - FREQUENCIES[i]);
+                    return static_cast<float>(LEVELS[i] + slope * (frequency - FREQUENCIES[i]));
+                }
+            }
+            return LEVELS[NUM_BANDS - 1];
+        }
+
+        struct Table {
+            float gains[TABLE_SIZE];
+        };
+
+        constexpr Table makeTable() {
+            Table table{};
+            for (int i = 0; i < TABLE_SIZE; i++) {
+                const double note = MIN_NOTE + static_cast<double>(i) / STEPS_PER_NOTE;
+                table.gains[i] = levelAt(440.0 * exp2((note - 57.0) / 12.0)) / REFERENCE_LEVEL;
+            }
+            return table;
+        }
+
+        /// Gain at MIN_NOTE + i / STEPS_PER_NOTE
+        constexpr Table TABLE = makeTable();
+    }
+
+    /// @brief Loudness compensation gain of a fractional note number (A4 == 57), clamped to the table's range
+    inline float equalLoudnessFromNote(const float note) {
+        const float index = (note - loudness::MIN_NOTE) * loudness::STEPS_PER_NOTE;
+        if (!(index > 0.f)) return loudness::TABLE.gains[0];
+        if (index >= loudness::TABLE_SIZE - 1) return loudness::TABLE.gains[loudness::TABLE_SIZE - 1];
+
+        const int i = static_cast<int>(index);
+        const float frac = index - static_cast<float>(i);
+        return loudness::TABLE.gains[i] + frac * (loudness::TABLE.gains[i + 1] - loudness::TABLE.gains[i]);
+    }
+
+    /// @brief Loudness compensation gain of a frequency in Hz
+    inline float equalLoudness(const float pitch) {
+        return equalLoudnessFromNote(57.f + 12.f * ::log2f(pitch / 440.f));
+    }
+}
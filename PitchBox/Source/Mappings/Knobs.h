@@ -1,3 +1,4 @@
+#pragma once
 #include <math.h>
 #include "daisysp.h"
 
@@ -12,7 +13,7 @@ namespace mapping {
     /// 0-0.5 is mapped between MIN and MID, and 0.5-1 is mapped between MID and MAX
     /// @param value0To1 A value which will be mapped. Must be between 0 and 1.
     /// @return The mapped value
-    float intervalVolumeScaled(const float value0To1){
+    inline float intervalVolumeScaled(const float value0To1){
         if(value0To1 < 1.f/2.f){
             return daisysp::fmap(value0To1 * 2.f, MIN_INTERVAL_VOLUME, MID_INTERVAL_VOLUME);
         }
@@ -25,7 +26,7 @@ namespace mapping {
     /// @brief Mapping of the anchors size. Value 0 to 1 is mapped to values definded as MIN and MAX anchors size
     /// @param value0To1 A value which will be mapped. Must be between 0 and 1.
     /// @return The mapped value
-    float anchorsSizeScaled(const float value0To1){
+    inline float anchorsSizeScaled(const float value0To1){
         return daisysp::fmap(value0To1, MIN_ANCHORS_SIZE, MAX_ANCHORS_SIZE);
     }
 
@@ -35,7 +36,7 @@ namespace mapping {
     /// @brief Mapping of the effects intensity. Value 0 to 1 is mapped to values definded as MIN and MAX anchors size
     /// @param value0To1 A value which will be mapped. Must be between 0 and 1.
     /// @return The mapped value
-    float effectsInternsityScaled(const float value0To1){
+    inline float effectsInternsityScaled(const float value0To1){
         return daisysp::fmap(value0To1, MIN_EFFECTS_INTENSITY, MAX_EFFECTS_INTENSITY);
     }
 
@@ -45,7 +46,7 @@ namespace mapping {
     /// @brief Mapping of the cutoff frequency. Value 0 to 1 is exponetiatly mapped to values definded as MIN and MAX anchors size
     /// @param value0To1 A value which will be mapped. Must be between 0 and 1.
     /// @return The mapped value
-    float cutoffScaled(const float value0To1){
+    inline float cutoffScaled(const float value0To1){
         return daisysp::fmap(value0To1, MIN_CUTOFF, MAX_CUTOFF, daisysp::Mapping::EXP);
     }
 }
\ No newline at end of file
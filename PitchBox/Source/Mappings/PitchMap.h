@@ -0,0 +1,115 @@
+#pragma once
+#include <math.h>
+#include <stddef.h>
+#include "Scale.h"
+
+/// @brief Cache of the pitch mapping: note and equal loudness gain for every mm of hand distance, for the current
+/// scale and anchors size. A lookup is two loads and a lerp instead of Scale::noteFromDistance() and
+/// equalLoudnessFromNote().
+///
+/// The anchors size is the only other input of the mapping and rarely changes. When it does, the new table is built in
+/// a second buffer a few entries per update() (per audio callback), the old one keeps serving lookups meanwhile and
+/// the two are swapped when it's done. Widths the current table wasn't built for are computed directly.
+///
+/// The two tables (19 KB) are storage handed in with setTables(), so they can live in another memory than the map.
+/// Without them everything is computed directly.
+class PitchMap {
+public:
+    static constexpr float MAX_DISTANCE = 1200.f; // mm, scales reaching further are held at their note here
+    static const size_t SIZE = static_cast<size_t>(MAX_DISTANCE) + 1; // one entry per mm
+
+    /// Entries built per update(), a whole table takes 10 callbacks
+    static const size_t ENTRIES_PER_UPDATE = 128;
+
+    /// A table serves widths this close to the one it was built for (mm). Keeps the ADC noise of the knob from
+    /// restarting the build, it moves the plateau edges by a fraction of a mm
+    static constexpr float WIDTH_TOLERANCE = 0.25f;
+
+    struct Entry {
+        float note;         // fractional MIDI note number
+        float loudness;     // equal loudness gain of the note's frequency
+    };
+
+    /// Storage of the front and back table
+    struct Tables {
+        Entry entries[2][SIZE];
+    };
+
+    /// @brief Sets the storage the tables are built in, nullptr computes every mapping directly
+    void setTables(Tables* storage) noexcept {
+        tables = storage;
+        isValid = false;
+        isBuilding = false;
+    }
+
+    /// @brief Replaces the scale, the mapping is computed directly until the table for it is built
+    void setScale(const Scale& newScale) noexcept {
+        scale = newScale;
+        isValid = false;
+        isBuilding = false;
+    }
+
+    const Scale& getScale() const noexcept { return scale; }
+
+    /// @brief The mapping without the cache
+    Entry compute(const float distance, const float anchorsSize) noexcept {
+        const float note = scale.noteFromDistance(distance, anchorsSize);
+        return {note, mapping::equalLoudnessFromNote(note)};
+    }
+
+    /// @brief Continues building the table for given anchors size, swaps it in once it's complete.
+    /// Call once per callback, only the table build of the newest width continues
+    void update(const float anchorsSize) noexcept {
+        if (!tables) return;
+        if (isValid && fabsf(anchorsSize - widths[front]) < WIDTH_TOLERANCE) {
+            isBuilding = false; // back at the width of the current table
+            return;
+        }
+
+        const int back = 1 - front;
+        if (!isBuilding || fabsf(anchorsSize - widths[back]) >= WIDTH_TOLERANCE) {
+            widths[back] = anchorsSize;
+            built = 0;
+            isBuilding = true;
+        }
+
+        const size_t end = built + ENTRIES_PER_UPDATE < SIZE ? built + ENTRIES_PER_UPDATE : SIZE;
+        for (; built < end; built++) tables->entries[back][built] = compute(static_cast<float>(built), widths[back]);
+
+        if (built == SIZE) {
+            front = back;
+            isValid = true;
+            isBuilding = false;
+        }
+    }
+
+    /// @brief True if lookup() reads the table for given anchors size
+    bool isReady(const float anchorsSize) const noexcept {
+        return isValid && fabsf(anchorsSize - widths[front]) < WIDTH_TOLERANCE;
+    }
+
+    /// @brief Note and loudness at given distance, interpolated between the mm of the table
+    Entry lookup(const float distance, const float anchorsSize) noexcept {
+        if (!isReady(anchorsSize)) return compute(distance, anchorsSize);
+
+        const float position = fminf(fmaxf(distance, 0.f), MAX_DISTANCE);
+        const size_t i = static_cast<size_t>(position);
+        if (i >= SIZE - 1) return tables->entries[front][SIZE - 1];
+
+        const float frac = position - static_cast<float>(i);
+        const Entry& a = tables->entries[front][i];
+        const Entry& b = tables->entries[front][i + 1];
+        return {a.note + frac * (b.note - a.note), a.loudness + frac * (b.loudness - a.loudness)};
+    }
+
+private:
+    Scale scale;
+
+    Tables* tables = nullptr;
+    float widths[2] = {0.f, 0.f};
+
+    int front = 0;
+    bool isValid = false;       // the front table is complete
+    bool isBuilding = false;    // the back table is being built
+    size_t built = 0;           // entries of the back table built so far
+};
@@ -0,0 +1,136 @@
+#pragma once
+#include <math.h>
+#include "SonicSensor.h"
+
+namespace mapping {
+    /// Note sets for Scale::setNotes(), over the range of the original mapping (E3 == 48 in this project)
+    namespace scales {
+        const float CHROMATIC[] = {48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60};
+        const float MAJOR[] = {48, 50, 52, 53, 55, 57, 59, 60};
+        const float NATURAL_MINOR[] = {48, 50, 51, 53, 55, 56, 58, 60};
+        const float PENTATONIC[] = {48, 50, 52, 55, 57, 60};
+    }
+}
+
+/// @brief Maps the hand distance to a (fractional) note of an arbitrary scale. Every note of the scale sits at a
+/// position in the playing range and holds a plateau of the anchors size around it, the notes are glided between
+/// in the rest of each zone. Below the first and above the last note the pitch stays put.
+///
+/// Loading a scale computes the note positions, the anchors size the plateau and transition breakpoints. Both are
+/// cached along with a coarse index into the breakpoints, so a mapping is a lookup, a step or two forward and one
+/// interpolation. The default scale is the chromatic one of mapping::indexFromDistance().
+class Scale {
+public:
+    static const int MAX_NOTES = 32;
+
+    /// Buckets of the breakpoint index over the range of the scale
+    static const int NUM_BUCKETS = 128;
+
+    Scale() { setNotes(mapping::scales::CHROMATIC, sizeof(mapping::scales::CHROMATIC) / sizeof(float)); }
+
+    /// @brief Loads a scale
+    /// @param newNotes Notes in the order of their positions, fractional MIDI note numbers
+    /// @param count Number of notes, 1 to MAX_NOTES
+    /// @param minDistance Position of the first note in mm
+    /// @param maxDistance Position of the last note in mm
+    /// @param zoneWidths count - 1 relative widths of the zones between the notes, nullptr for equal zones
+    /// @return false if the scale is invalid, the current one is kept then
+    bool setNotes(const float* newNotes, const int count, const float minDistance = mapping::MIN_DISTANCE,
+        const float maxDistance = mapping::MAX_DISTANCE, const float* zoneWidths = nullptr) noexcept
+    {
+        if (count < 1 || count > MAX_NOTES || !(maxDistance >= minDistance)) return false;
+
+        float total = 0.f;
+        for (int i = 0; i < count - 1; i++) {
+            const float width = zoneWidths ? zoneWidths[i] : 1.f;
+            if (!(width > 0.f)) return false;
+            total += width;
+        }
+
+        float position = minDistance;
+        for (int i = 0; i < count; i++) {
+            notes[i] = newNotes[i];
+            positions[i] = position;
+            if (i < count - 1) position += (maxDistance - minDistance) * (zoneWidths ? zoneWidths[i] : 1.f) / total;
+        }
+        positions[count - 1] = maxDistance; // no rounding error at the end of the range
+        numNotes = count;
+
+        breakpointsWidth = -1.f; // recomputed on the next mapping
+        return true;
+    }
+
+    int getNumNotes() const noexcept { return numNotes; }
+    float getNote(const int i) const noexcept { return notes[i]; }
+    float getPosition(const int i) const noexcept { return positions[i]; }
+
+    /// @brief The note at given distance
+    /// @param distance Hand distance in mm
+    /// @param anchorsSize Width of the plateaus in mm, limited to the zones around each note
+    float noteFromDistance(const float distance, const float anchorsSize) noexcept
+    {
+        if (anchorsSize != breakpointsWidth) updateBreakpoints(anchorsSize);
+
+        if (!(distance >= breakpoints[0])) return values[0];
+        if (distance >= breakpoints[numBreakpoints - 1]) return values[numBreakpoints - 1];
+
+        // last breakpoint at or below the distance, from the last one at or below the bucket's start
+        const int bucket = static_cast<int>((distance - breakpoints[0]) * bucketScale);
+        int i = bucketStart[bucket < NUM_BUCKETS ? bucket : NUM_BUCKETS - 1];
+        while (breakpoints[i + 1] <= distance) i++;
+
+        return values[i] + (distance - breakpoints[i]) * slopes[i];
+    }
+
+private:
+    /// Both edges of every plateau, the segments between them are the transitions
+    void updateBreakpoints(const float anchorsSize) noexcept
+    {
+        const float halfWidth = anchorsSize > 0.f ? anchorsSize * 0.5f : 0.f;
+
+        numBreakpoints = 0;
+        for (int i = 0; i < numNotes; i++) {
+            const float below = i > 0 ? fminf(halfWidth, (positions[i] - positions[i - 1]) * 0.5f) : 0.f;
+            const float above = i < numNotes - 1 ? fminf(halfWidth, (positions[i + 1] - positions[i]) * 0.5f) : 0.f;
+
+            addBreakpoint(positions[i] - below, notes[i]);
+            if (below + above > 0.f) addBreakpoint(positions[i] + above, notes[i]);
+        }
+
+        for (int i = 0; i < numBreakpoints - 1; i++) {
+            const float length = breakpoints[i + 1] - breakpoints[i];
+            slopes[i] = length > 0.f ? (values[i + 1] - values[i]) / length : 0.f;
+        }
+        slopes[numBreakpoints - 1] = 0.f;
+
+        const float range = breakpoints[numBreakpoints - 1] - breakpoints[0];
+        bucketScale = range > 0.f ? NUM_BUCKETS / range : 0.f;
+        for (int bucket = 0, i = 0; bucket < NUM_BUCKETS; bucket++) {
+            const float start = breakpoints[0] + bucket * range / NUM_BUCKETS;
+            while (i < numBreakpoints - 2 && breakpoints[i + 1] <= start) i++;
+            bucketStart[bucket] = i;
+        }
+
+        breakpointsWidth = anchorsSize;
+    }
+
+    void addBreakpoint(const float distance, const float note) noexcept
+    {
+        breakpoints[numBreakpoints] = distance;
+        values[numBreakpoints] = note;
+        numBreakpoints++;
+    }
+
+    float notes[MAX_NOTES];
+    float positions[MAX_NOTES]; // mm
+    int numNotes = 0;
+
+    float breakpoints[2 * MAX_NOTES]; // mm, ascending
+    float values[2 * MAX_NOTES]; // note at each breakpoint
+    float slopes[2 * MAX_NOTES]; // notes per mm up to the next breakpoint
+    int numBreakpoints = 0;
+    float breakpointsWidth = -1.f; // anchors size the breakpoints were computed for
+
+    int bucketStart[NUM_BUCKETS]; // last breakpoint at or below the start of each bucket
+    float bucketScale = 0.f; // buckets per mm
+};
@@ -1,42 +1,61 @@
+#pragma once
 #include <math.h>
+#include <stddef.h>
+#include "../FM/Lanes.h"
 
-/// @brief A smoothing class for floating point parameters
+/// @brief A smoothing class for floating point parameters. Ramps take a fixed time, independent of how often the
+/// value is read: per sample with getNextValue(), process() and applyGain(), or a whole block at once with advance().
 class Smoothing {
 public:
-    Smoothing(int steps = 0) : 
-        defaultStepsToTarget(steps), countdown(steps) {};
+    enum class Mode {
+        LINEAR,         // constant slope, reaches the target exactly after the ramp time
+        EXPONENTIAL     // one-pole, within 1 % (-40 dB) of the target after the ramp time
+    };
+
+    /// @param rampMs Time to reach a new target in milliseconds, 0 jumps right to it
+    Smoothing(const float rampMs = 0.f, const Mode mode = Mode::LINEAR) :
+        rampTime(rampMs), mode(mode) { updateRamp(); };
+
+    /// @brief Sets the sample rate the value is read at, the ramp time is kept
+    void setSampleRate(const float newSampleRate) noexcept{
+        sampleRate = newSampleRate;
+        updateRamp();
+    }
+
+    /// @brief Sets the ramp time in milliseconds, applies from the next target on
+    void setRampTime(const float rampMs) noexcept{
+        rampTime = rampMs;
+        updateRamp();
+    }
 
     void setCurrentAndTargetValue (const float newValue) noexcept{
         currentValue = target = newValue;
         countdown = 0;
     }
 
-    /// @brief Sets next target value. The target value will be reached after numSteps
-    /// @param newValue 
+    /// @brief Sets next target value. The target value will be reached after the ramp time
+    /// @param newValue
     void setTargetValue(const float newValue) noexcept{
         if (std::abs(newValue - target) < 0.0001f) return;
-        
+
         target = newValue;
-        
-        if (defaultStepsToTarget <= 0)
+
+        if (rampSamples <= 0)
         {
             setCurrentAndTargetValue (newValue);
             return;
         }
 
-        target = newValue;
-        countdown = defaultStepsToTarget;
-
+        // the one-pole never quite arrives, it's snapped to the target after twice the ramp time (-80 dB)
+        countdown = mode == Mode::LINEAR ? rampSamples : 2 * rampSamples;
         stepSize = (target - currentValue) / static_cast<float>(countdown);
     }
 
-    void reset (int numSteps) noexcept
-    {
-        defaultStepsToTarget = numSteps;
-        setCurrentAndTargetValue(target);
-    }
+    float getTargetValue() const noexcept { return target; }
+    float getCurrentValue() const noexcept { return currentValue; }
+    bool isSmoothing() const noexcept { return countdown > 0; }
 
-    /// @brief Updates countdown and the current value 
+    /// @brief Advances the value by one sample
     /// @return The next value of the parameter
     float getNextValue() noexcept
     {
@@ -44,20 +63,123 @@ public:
 
         countdown--;
 
-        if (isSmoothing()) currentValue += stepSize;
-        else currentValue = target;
+        if (!isSmoothing()) currentValue = target;
+        else if (mode == Mode::LINEAR) currentValue += stepSize;
+        else currentValue = target + coefficient * (currentValue - target);
 
         return currentValue;
     }
 
+    /// @brief Advances the value by n samples at once, for parameters which are only updated once per block
+    /// @return The value after n samples
+    float advance(const size_t n) noexcept
+    {
+        if (!isSmoothing()) return target;
+
+        const int steps = n < static_cast<size_t>(countdown) ? static_cast<int>(n) : countdown;
+        countdown -= steps;
+
+        if (!isSmoothing()) currentValue = target;
+        else if (mode == Mode::LINEAR) currentValue += stepSize * steps;
+        else currentValue = target + ::powf(coefficient, static_cast<float>(steps)) * (currentValue - target);
+
+        return currentValue;
+    }
+
+    /// @brief Writes the values of the next n samples
+    void process(float* dst, const size_t n) noexcept { render<false>(dst, n); }
+
+    /// @brief Multiplies n samples by the values of the next n samples
+    void applyGain(float* buffer, const size_t n) noexcept { render<true>(buffer, n); }
+
 private:
-    bool isSmoothing() { return countdown > 0; }
- 
+    void updateRamp() noexcept
+    {
+        rampSamples = static_cast<int>(rampTime * 0.001f * sampleRate + 0.5f);
+        coefficient = rampSamples > 0 ? ::expf(::logf(0.01f) / rampSamples) : 0.f;
+    }
+
+    /// The block kernels, four samples at a time while ramping, then the constant target
+    template <bool IS_GAIN>
+    void render(float* buffer, const size_t n) noexcept
+    {
+        using namespace lanes;
+
+        const size_t ramp = n < static_cast<size_t>(countdown) ? n : static_cast<size_t>(countdown);
+        size_t i = 0;
+
+        if (ramp > 0) {
+            float4 values;
+            if (mode == Mode::LINEAR) {
+                const float4 base = broadcast(currentValue);
+                const float4 step = broadcast(stepSize);
+                float4 index = {1.f, 2.f, 3.f, 4.f}; // exact integers, no error builds up over the ramp
+
+                for (; i + WIDTH <= ramp; i += WIDTH) {
+                    values = base + step * index;
+                    storeOrScale<IS_GAIN>(buffer + i, values);
+                    index += broadcast(4.f);
+                }
+                values = base + step * index;
+            }
+            else {
+                const float a = coefficient;
+                const float4 offset = broadcast(target);
+                const float4 decay = broadcast(a * a * a * a);
+                float4 distance = broadcast(currentValue - target) * float4{a, a * a, a * a * a, a * a * a * a};
+
+                for (; i + WIDTH <= ramp; i += WIDTH) {
+                    storeOrScale<IS_GAIN>(buffer + i, offset + distance);
+                    distance *= decay;
+                }
+                values = offset + distance;
+            }
+
+            // the last few samples of the ramp, values holds them
+            for (size_t j = 0; i < ramp; i++, j++) {
+                if (IS_GAIN) buffer[i] *= values[j];
+                else buffer[i] = values[j];
+            }
+
+            countdown -= static_cast<int>(ramp);
+            currentValue = isSmoothing() ? (IS_GAIN ? valueAfter(ramp) : buffer[ramp - 1]) : target;
+            if (!isSmoothing() && !IS_GAIN) buffer[ramp - 1] = target;
+        }
+
+        if (i == n) return;
+
+        const float4 constant = broadcast(target);
+        for (; i + WIDTH <= n; i += WIDTH) storeOrScale<IS_GAIN>(buffer + i, constant);
+        for (; i < n; i++) {
+            if (IS_GAIN) buffer[i] *= target;
+            else buffer[i] = target;
+        }
+    }
+
+    template <bool IS_GAIN>
+    static void storeOrScale(float* buffer, const lanes::float4 values) noexcept
+    {
+        if (IS_GAIN) lanes::store(buffer, lanes::load(buffer) * values);
+        else lanes::store(buffer, values);
+    }
+
+    /// Value steps samples after the current one, while still ramping
+    float valueAfter(const size_t steps) const noexcept
+    {
+        if (mode == Mode::LINEAR) return currentValue + stepSize * steps;
+        return target + ::powf(coefficient, static_cast<float>(steps)) * (currentValue - target);
+    }
+
     float currentValue = 0.f;
     float target = currentValue;
-    
-    float stepSize = 0.f; // how much do we add/subtract every getNextValue() call
 
-    int defaultStepsToTarget = 0;
-    int countdown = defaultStepsToTarget;
-};
\ No newline at end of file
+    float stepSize = 0.f; // how much do we add/subtract every getNextValue() call, linear mode
+    float coefficient = 0.f; // how much of the distance to the target is left after every call, exponential mode
+
+    float rampTime = 0.f; // ms
+    float sampleRate = 48000.f;
+    Mode mode = Mode::LINEAR;
+
+    int rampSamples = 0;
+    int countdown = 0;
+};
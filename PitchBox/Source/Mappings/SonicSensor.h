@@ -1,10 +1,12 @@
+#pragma once
 #include <math.h>
+#include "EqualLoudness.h"
 
 namespace mapping{
     const float MAX_DISTANCE = 1000.f; // mm
     const float MIN_DISTANCE = 200.f; // mm
 
-    static float indexFromDistance(const float distance, const float stepWidth = 20.f)
+    inline float indexFromDistance(const float distance, const float stepWidth = 20.f)
     {
         const float xOffset = MIN_DISTANCE;
         const float xInterval = MAX_DISTANCE - MIN_DISTANCE;
@@ -27,29 +29,14 @@ namespace mapping{
         return firstNote + ::floorf(d / ss) + (dss - stepWidth / 2.f) / (ss - stepWidth);
     }
 
-    static float pitchFromDistance(const float distance, const float stepWidth = 20.f){
+    inline float pitchFromDistance(const float distance, const float stepWidth = 20.f){
         const auto noteIndex = indexFromDistance(distance, stepWidth);
         return ::powf(2, ((noteIndex - 57.f) / 12.f)) * 440.f;
     }
 
-    const int lengthPitches = 7;
-    const float pitches[] = { 160,     200,	    250,	315, 	400, 	500, 	630 }; //Hz
-    const float volumes[] = {  87.82,   85.92,	84.31,	82.89,	81.68,	80.86,	80.17 }; // 80dB level == deafult
-
-    static float equalLoudness(const float pitch){
-        for(auto i = 0; i < lengthPitches - 1; i++){
-            if(pitch > pitches[i] && pitch < pitches[i + 1]){
-                auto dy = volumes[i + 1] - volumes[i];
-                auto dx = pitches[i + 1] - pitches[i];
-                return (dy / dx * (pitch - pitches[i]) + volumes[i]) / 80.f;
-            }
-        }
-        return 1.f;
-    }
-
     const float MIN_VOLUME = -60; 
 
-    static float gainFromDistance(const float distance){
+    inline float gainFromDistance(const float distance){
         if(distance < MIN_DISTANCE) return 0.f;
         if(distance > MAX_DISTANCE) return 1.f;
         auto x = distance - MIN_DISTANCE;
@@ -0,0 +1,109 @@
+#include "DistanceFilter.h"
+
+float OnePoleFilter::process(const float distance, const float /*dt*/){
+	value = distance + alpha * (value - distance);
+	return value;
+}
+
+MedianFilter::MedianFilter(const int newWindow, const int newMaxMisses) :
+	window(newWindow < 1 ? 1 : (newWindow > MAX_WINDOW ? MAX_WINDOW : newWindow)), maxMisses(newMaxMisses) {}
+
+float MedianFilter::process(const float distance, const float /*dt*/){
+	if(distance < 0.f){
+		if(++misses >= maxMisses) reset();
+		return value;
+	}
+	misses = 0;
+
+	history[next] = distance;
+	next = (next + 1) % window;
+	if(count < window) count++;
+
+	// insertion sort of at most MAX_WINDOW values, cheaper than anything fancier at this size
+	float sorted[MAX_WINDOW];
+	for(int i = 0; i < count; i++){
+		const float x = history[i];
+		int j = i;
+		for(; j > 0 && sorted[j - 1] > x; j--) sorted[j] = sorted[j - 1];
+		sorted[j] = x;
+	}
+
+	value = sorted[count / 2];
+	return value;
+}
+
+void MedianFilter::reset(){
+	count = next = misses = 0;
+	value = -1.f;
+}
+
+float KalmanFilter::process(const float distance, const float dt){
+	if(!isTracking){
+		if(distance < 0.f) return -1.f;
+		restart(distance);
+		return position;
+	}
+
+	predict(dt);
+
+	bool accepted = false;
+	if(distance >= 0.f){
+		const float innovation = distance - position;
+		const float s = p00 + config.measurementNoise;
+
+		if(innovation * innovation <= config.gate * config.gate * s){
+			const float k0 = p00 / s;
+			const float k1 = p01 / s;
+
+			position += k0 * innovation;
+			velocity += k1 * innovation;
+
+			p11 -= k1 * p01;
+			p01 -= k0 * p01;
+			p00 -= k0 * p00;
+			accepted = true;
+		}
+	}
+
+	if(accepted) misses = 0;
+	else if(++misses >= config.maxMisses){
+		// a consistent reading far from the track is a jump of the hand, a timeout means it's gone
+		if(distance >= 0.f) restart(distance);
+		else {
+			reset();
+			return -1.f;
+		}
+	}
+
+	return position;
+}
+
+void KalmanFilter::reset(){
+	isTracking = false;
+	misses = 0;
+	position = velocity = 0.f;
+	p00 = p01 = p11 = 0.f;
+}
+
+void KalmanFilter::predict(const float dt){
+	position += velocity * dt;
+
+	// P = F P F' + Q, with Q of a white noise acceleration
+	const float q = config.accelerationNoise;
+	const float dt2 = dt * dt;
+	p00 += dt * 2.f * p01 + dt2 * p11 + q * dt2 * dt * (1.f / 3.f);
+	p01 += dt * p11 + q * dt2 * 0.5f;
+	p11 += q * dt;
+}
+
+void KalmanFilter::restart(const float distance){
+	isTracking = true;
+	misses = 0;
+	position = distance;
+	velocity = 0.f;
+
+	// the velocity is unknown, hands move up to a few m/s
+	p00 = config.measurementNoise;
+	p01 = 0.f;
+	p11 = 2000.f * 2000.f;
+}
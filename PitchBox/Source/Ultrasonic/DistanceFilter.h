@@ -0,0 +1,91 @@
+#pragma once
+#include <cstdint>
+
+/// @brief Filter stage between the raw ultrasonic measurements and the mappings. Runs once per measurement in the
+/// main loop. Raw readings come with a negative distance on a timeout, the filters decide how to bridge those.
+class DistanceFilter {
+public:
+	virtual ~DistanceFilter() = default;
+
+	/// @brief Filters one measurement
+	/// @param distance Raw distance in mm, negative on a timeout
+	/// @param dt Time since the previous measurement in seconds
+	/// @return The filtered distance in mm, negative once the hand is considered gone
+	virtual float process(const float distance, const float dt) = 0;
+
+	/// @brief Hand velocity in mm/s, positive when moving away from the sensor. 0 if the filter doesn't track it.
+	virtual float getVelocity() const { return 0.f; }
+
+	/// @brief Forgets the history
+	virtual void reset() = 0;
+};
+
+/// @brief The original one-pole lowpass of Ultrasonic::getDistanceFiltered, timeouts included. Kept as a reference.
+class OnePoleFilter : public DistanceFilter {
+public:
+	OnePoleFilter(const float alpha = .5f) : alpha(alpha) {}
+
+	float process(const float distance, const float dt) override;
+	void reset() override { value = 0.f; }
+
+private:
+	float alpha;
+	float value{0.f};
+};
+
+/// @brief Median of the last few valid readings. Single timeouts and outliers are dropped, the hand is only
+/// reported gone after maxMisses timeouts in a row.
+class MedianFilter : public DistanceFilter {
+public:
+	static const int MAX_WINDOW = 9;
+
+	/// @param window Number of readings the median is taken from, odd, at most MAX_WINDOW
+	/// @param maxMisses Timeouts in a row after which the hand is gone
+	MedianFilter(const int window = 5, const int maxMisses = 3);
+
+	float process(const float distance, const float dt) override;
+	void reset() override;
+
+private:
+	int window;
+	int maxMisses;
+
+	float history[MAX_WINDOW];
+	int count{0};
+	int next{0};
+	int misses{0};
+	float value{-1.f};
+};
+
+/// @brief Constant velocity Kalman filter tracking hand position and velocity. Timeouts and readings too far from
+/// the prediction (gated by the innovation) only advance the prediction. After maxMisses of them in a row the
+/// track is dropped: a timeout reports the hand as gone, a valid reading restarts the track from it.
+class KalmanFilter : public DistanceFilter {
+public:
+	struct Config {
+		float measurementNoise{9.f};		// mm², variance of one reading
+		float accelerationNoise{4e7f};		// mm²/s³, spectral density of the hand's acceleration
+		float gate{4.f};					// standard deviations of the innovation a reading may be off
+		int maxMisses{3};
+	};
+
+	KalmanFilter() : KalmanFilter(Config()) {}
+	KalmanFilter(const Config& config) : config(config) {}
+
+	float process(const float distance, const float dt) override;
+	float getVelocity() const override { return isTracking ? velocity : 0.f; }
+	void reset() override;
+
+private:
+	void predict(const float dt);
+	void restart(const float distance);
+
+	Config config;
+
+	bool isTracking{false};
+	int misses{0};
+
+	float position{0.f};
+	float velocity{0.f};
+	float p00{0.f}, p01{0.f}, p11{0.f}; // covariance
+};
@@ -0,0 +1,58 @@
+#include "EchoCapture.h"
+
+bool EchoCapture::start(const uint32_t newTriggerTime, const uint32_t timeoutUs){
+	if(isBusy()) return false;
+
+	triggerTime = newTriggerTime;
+	timeout = timeoutUs;
+	state.store(State::WAIT_RISE, std::memory_order_release);
+	return true;
+}
+
+void EchoCapture::onEdge(const bool level, const uint32_t time){
+	const auto current = state.load(std::memory_order_acquire);
+	if(current == State::IDLE) return;
+
+	// edges from before the trigger (a late echo of the previous ping) or after the window don't belong to us
+	if(time - triggerTime > timeout) return;
+
+	if(current == State::WAIT_RISE){
+		// a falling edge here is the end of a pulse which started before the trigger, keep waiting
+		if(!level) return;
+
+		riseTime = time;
+		auto expected = State::WAIT_RISE;
+		state.compare_exchange_strong(expected, State::WAIT_FALL, std::memory_order_acq_rel);
+	}
+	else if(!level){
+		finish(State::WAIT_FALL, static_cast<int32_t>(time - riseTime), time - triggerTime);
+	}
+}
+
+void EchoCapture::poll(const uint32_t now){
+	const auto current = state.load(std::memory_order_acquire);
+	if(current == State::IDLE) return;
+
+	if(now - triggerTime >= timeout) finish(current, TIMEOUT, timeout);
+}
+
+bool EchoCapture::takeResult(int32_t& pulseUs){
+	uint32_t listenUs;
+	return takeResult(pulseUs, listenUs);
+}
+
+bool EchoCapture::takeResult(int32_t& pulseUs, uint32_t& listenUs){
+	if(!hasResult.exchange(false, std::memory_order_acquire)) return false;
+
+	pulseUs = result.load(std::memory_order_relaxed);
+	listenUs = resultListen.load(std::memory_order_relaxed);
+	return true;
+}
+
+void EchoCapture::finish(State from, const int32_t pulseUs, const uint32_t listenUs){
+	if(!state.compare_exchange_strong(from, State::IDLE, std::memory_order_acq_rel)) return;
+
+	result.store(pulseUs, std::memory_order_relaxed);
+	resultListen.store(listenUs, std::memory_order_relaxed);
+	hasResult.store(true, std::memory_order_release);
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+/// @brief Hardware independent state machine of one ultrasonic measurement. The trigger pulse starts it, the edges
+/// of the echo pin (from the pin interrupt) advance it and the main loop only checks the timeout and collects the
+/// result, so nothing waits for the echo. All times are in microseconds from a free running, wrapping counter.
+///
+/// onEdge() may preempt poll() and takeResult(), the measurement is finished by whichever of them gets there first.
+class EchoCapture {
+public:
+	enum class State : uint8_t {
+		IDLE,		// no measurement running, the last result can be taken
+		WAIT_RISE,	// trigger sent, waiting for the echo pulse to start
+		WAIT_FALL	// echo pulse started, waiting for it to end
+	};
+
+	/// Result of a measurement with no complete echo pulse inside the timeout
+	static const int32_t TIMEOUT = -1;
+
+	EchoCapture() = default;
+	~EchoCapture() = default;
+
+	/// @brief Starts a new measurement, the trigger pulse has just been sent
+	/// @param triggerTime Time the trigger pulse ended
+	/// @param timeoutUs Length of the listening window, counted from the trigger
+	/// @return false if the previous measurement is still running, nothing is started then
+	bool start(const uint32_t triggerTime, const uint32_t timeoutUs);
+
+	/// @brief Advances the state machine by one edge of the echo pin. Meant to be called from the pin interrupt.
+	/// @param level The level of the pin after the edge
+	/// @param time Time of the edge
+	void onEdge(const bool level, const uint32_t time);
+
+	/// @brief Finishes the measurement with TIMEOUT once its listening window has passed. Meant to be called from
+	/// the main loop.
+	void poll(const uint32_t now);
+
+	/// @brief Takes the result of the last finished measurement
+	/// @param pulseUs Length of the echo pulse in microseconds, or TIMEOUT
+	/// @return true if a measurement finished since the last call, pulseUs is left untouched otherwise
+	bool takeResult(int32_t& pulseUs);
+
+	/// @brief Same as above, also returns how long after the trigger the echo ended (the time the sensor needed)
+	/// @param listenUs Time from the trigger to the end of the echo, or the timeout
+	bool takeResult(int32_t& pulseUs, uint32_t& listenUs);
+
+	State getState() const { return state.load(std::memory_order_acquire); }
+	bool isBusy() const { return getState() != State::IDLE; }
+
+private:
+	/// Moves from given state to IDLE and publishes the pulse, unless someone else has finished the measurement
+	void finish(State from, const int32_t pulseUs, const uint32_t listenUs);
+
+	std::atomic<State> state{State::IDLE};
+	uint32_t triggerTime{0};
+	uint32_t timeout{0};
+	uint32_t riseTime{0};
+
+	std::atomic<int32_t> result{TIMEOUT};
+	std::atomic<uint32_t> resultListen{0};
+	std::atomic<bool> hasResult{false};
+};
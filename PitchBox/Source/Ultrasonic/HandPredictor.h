@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+
+/// @brief Extrapolates the filtered hand position ahead in time, to make up for the lag between moving the hand and
+/// hearing it (time of flight, the filter, the parameter smoothing and the audio block). Sits between the
+/// DistanceFilter of a sensor and the distance handed to the DSP core.
+///
+/// The prediction follows the velocity estimated by the filter, limited to maxOffset so a noisy velocity or a hand
+/// stopping abruptly can't throw the pitch far off. A lead time of 0 turns the prediction off.
+class HandPredictor {
+public:
+	struct Config {
+		float leadTime{0.02f};	// s, how far ahead of the measurement to predict
+		float maxOffset{60.f};	// mm, the largest correction applied, about one note
+	};
+
+	HandPredictor() : HandPredictor(Config()) {}
+	HandPredictor(const Config& config) : config(config) {}
+	~HandPredictor() = default;
+
+	void setLeadTime(const float seconds) { config.leadTime = seconds; }
+	float getLeadTime() const { return config.leadTime; }
+
+	/// @brief Stores a new filtered measurement
+	/// @param newPosition Filtered distance in mm, negative when there is no hand
+	/// @param newVelocity Hand velocity in mm/s
+	/// @param time Time in µs the hand was at that position
+	void update(const float newPosition, const float newVelocity, const uint32_t time){
+		position = newPosition;
+		velocity = newVelocity;
+		measurementTime = time;
+	}
+
+	/// @brief Returns where the hand will be lead time after given time
+	/// @param now Time in µs, the time passed since the measurement is extrapolated as well
+	float predict(const uint32_t now) const {
+		if(position < 0.f || config.leadTime <= 0.f) return position;
+
+		const float ahead = static_cast<float>(now - measurementTime) * 1e-6f + config.leadTime;
+		float offset = velocity * ahead;
+		if(offset > config.maxOffset) offset = config.maxOffset;
+		if(offset < -config.maxOffset) offset = -config.maxOffset;
+
+		const float predicted = position + offset;
+		return predicted < 0.f ? 0.f : predicted; // don't turn a prediction into "no hand"
+	}
+
+private:
+	Config config;
+
+	float position{-1.f};
+	float velocity{0.f};
+	uint32_t measurementTime{0};
+};
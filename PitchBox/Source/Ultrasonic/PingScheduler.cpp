@@ -0,0 +1,49 @@
+#include "PingScheduler.h"
+
+PingScheduler::PingScheduler(const Config& newConfig) : config(newConfig) {
+	for(auto& timeout: timeouts) timeout = config.maxTimeout;
+}
+
+int PingScheduler::next(const uint32_t now, uint32_t& timeoutUs) const {
+	if(isBusy) return -1;
+	if(now - lastTrigger < config.minPingSpacing) return -1;
+	if(now - lastFinish < config.guard) return -1;
+
+	timeoutUs = timeouts[turn];
+	return turn;
+}
+
+void PingScheduler::onPing(const int sensor, const uint32_t now){
+	isBusy = true;
+	lastTrigger = now;
+	pingCounts[sensor]++;
+}
+
+void PingScheduler::onResult(const int sensor, const int32_t pulseUs, const uint32_t listenUs, const uint32_t now){
+	isBusy = false;
+	lastFinish = now;
+	turn = (sensor + 1) % NUM_SENSORS;
+
+	if(pulseUs >= 0){
+		validCounts[sensor]++;
+
+		// track the hand, it moves at most a few mm between two pings of the same sensor
+		uint32_t timeout = listenUs + listenUs / 4 + config.trackingMargin;
+		if(timeout < config.minTimeout) timeout = config.minTimeout;
+		if(timeout > config.maxTimeout) timeout = config.maxTimeout;
+		timeouts[sensor] = timeout;
+	}
+	else {
+		timeouts[sensor] = config.maxTimeout; // lost, search the whole range
+	}
+
+	const uint32_t elapsed = now - rateWindowStart;
+	if(elapsed >= RATE_WINDOW){
+		for(int s = 0; s < NUM_SENSORS; s++){
+			updateRates[s] = validCounts[s] * 1e6f / elapsed;
+			pingRates[s] = pingCounts[s] * 1e6f / elapsed;
+			validCounts[s] = pingCounts[s] = 0;
+		}
+		rateWindowStart = now;
+	}
+}
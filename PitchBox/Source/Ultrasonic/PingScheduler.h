@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+
+/// @brief Decides when each of the two ultrasonic sensors pings and how long it listens. Hardware independent, the
+/// caller sends the triggers and reports the results (see UltrasonicPair).
+///
+/// The sensors take turns and never listen at the same time. A ping may only follow the previous one once that
+/// ping's sound has travelled past the range of the sensors (minPingSpacing after its trigger) and its echo has
+/// decayed (guard after its end), so the other sensor can't pick it up. Within those limits the next ping goes
+/// out as soon as possible.
+///
+/// Every sensor listens only around where its last echo came from: the window is the last listening time plus a
+/// tracking margin. A hand lost outside the window (or no hand at all) gives a timeout, after which the sensor
+/// listens over the whole range again.
+class PingScheduler {
+public:
+	static const int NUM_SENSORS = 2;
+
+	struct Config {
+		uint32_t maxTimeout{6000};		// µs, listening window without a tracked hand, 6k µs ~ 1200 mm
+		uint32_t minTimeout{1500};		// µs, the sensor needs ~500 µs before the echo even starts
+		uint32_t minPingSpacing{6000};	// µs from one trigger to the next, lets the sound leave the range
+		uint32_t guard{1000};			// µs from the end of a measurement to the next trigger
+		uint32_t trackingMargin{700};	// µs added to the last listening time, ~120 mm of hand movement
+	};
+
+	PingScheduler() : PingScheduler(Config()) {}
+	PingScheduler(const Config& config);
+	~PingScheduler() = default;
+
+	/// @brief Returns the sensor to ping now, or -1 while a measurement is running or the limits above aren't met
+	/// @param now Current time in µs
+	/// @param timeoutUs Listening window of the returned sensor
+	int next(const uint32_t now, uint32_t& timeoutUs) const;
+
+	/// @brief Called right after the trigger of given sensor was sent
+	void onPing(const int sensor, const uint32_t now);
+
+	/// @brief Called when the measurement of given sensor finished
+	/// @param pulseUs Length of the echo pulse, negative on a timeout
+	/// @param listenUs Time from the trigger to the end of the echo
+	void onResult(const int sensor, const int32_t pulseUs, const uint32_t listenUs, const uint32_t now);
+
+	/// @brief Current listening window of given sensor in µs
+	uint32_t getTimeout(const int sensor) const { return timeouts[sensor]; }
+
+	/// @brief Valid distances per second of given sensor, measured over the last second
+	float getUpdateRate(const int sensor) const { return updateRates[sensor]; }
+
+	/// @brief Pings per second of given sensor, measured over the last second
+	float getPingRate(const int sensor) const { return pingRates[sensor]; }
+
+private:
+	static const uint32_t RATE_WINDOW = 1000000; // µs
+
+	Config config;
+
+	int turn{0};
+	bool isBusy{false};
+	uint32_t lastTrigger{0};
+	uint32_t lastFinish{0};
+
+	uint32_t timeouts[NUM_SENSORS];
+
+	uint32_t rateWindowStart{0};
+	uint32_t validCounts[NUM_SENSORS]{};
+	uint32_t pingCounts[NUM_SENSORS]{};
+	float updateRates[NUM_SENSORS]{};
+	float pingRates[NUM_SENSORS]{};
+};
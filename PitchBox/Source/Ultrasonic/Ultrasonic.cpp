@@ -2,6 +2,59 @@
 #include <inttypes.h>
 #include "Ultrasonic.h"
 
+namespace {
+    /// Sensors listening on each EXTI line, lines are shared by all ports so there is at most one per pin number
+    Ultrasonic* extiSensors[16] = {};
+
+    GPIO_TypeDef* const ports[] = {GPIOA, GPIOB, GPIOC, GPIOD, GPIOE, GPIOF, GPIOG, GPIOH, GPIOI, GPIOJ, GPIOK};
+
+    IRQn_Type irqOfLine(const uint8_t line) {
+        if(line <= 4) return static_cast<IRQn_Type>(EXTI0_IRQn + line);
+        return line <= 9 ? EXTI9_5_IRQn : EXTI15_10_IRQn;
+    }
+
+    bool isEchoLine(const uint8_t line) {
+        return (ULTRASONIC_ECHO_LINES & (1u << line)) != 0;
+    }
+
+    void handleExti(const uint8_t first, const uint8_t last) {
+        const uint32_t now = daisy::System::GetUs(); // timestamp first, before anything else delays it
+        for(uint8_t line = first; line <= last; line++) {
+            const uint16_t mask = 1u << line;
+            // lines of a shared vector which aren't ours are left pending for whoever owns them
+            if(!isEchoLine(line) || !__HAL_GPIO_EXTI_GET_IT(mask)) continue;
+
+            __HAL_GPIO_EXTI_CLEAR_IT(mask);
+            if(extiSensors[line]) extiSensors[line]->onEchoEdge(now);
+        }
+    }
+}
+
+// Only the vectors of the echo lines, a vector defined here can't be defined anywhere else
+extern "C" {
+#if ULTRASONIC_ECHO_LINES & (1u << 0)
+    void EXTI0_IRQHandler() { handleExti(0, 0); }
+#endif
+#if ULTRASONIC_ECHO_LINES & (1u << 1)
+    void EXTI1_IRQHandler() { handleExti(1, 1); }
+#endif
+#if ULTRASONIC_ECHO_LINES & (1u << 2)
+    void EXTI2_IRQHandler() { handleExti(2, 2); }
+#endif
+#if ULTRASONIC_ECHO_LINES & (1u << 3)
+    void EXTI3_IRQHandler() { handleExti(3, 3); }
+#endif
+#if ULTRASONIC_ECHO_LINES & (1u << 4)
+    void EXTI4_IRQHandler() { handleExti(4, 4); }
+#endif
+#if ULTRASONIC_ECHO_LINES & 0x3E0u
+    void EXTI9_5_IRQHandler() { handleExti(5, 9); }
+#endif
+#if ULTRASONIC_ECHO_LINES & 0xFC00u
+    void EXTI15_10_IRQHandler() { handleExti(10, 15); }
+#endif
+}
+
 static uint32_t timeDiff(uint32_t begin, uint32_t end) {
     return end - begin;
 }
@@ -49,4 +102,79 @@ float Ultrasonic::getDistanceFiltered(const float alpha, const uint32_t timeout)
     const auto curDistance = getDistance(timeout);
     distance = curDistance + alpha * (distance - curDistance);
     return distance;
+}
+
+bool Ultrasonic::enableAsync() {
+    const uint8_t line = echoPinId.pin;
+    // without a vector the interrupt would end up in the default handler, which hangs
+    if(!isEchoLine(line)) return false;
+    extiSensors[line] = this;
+
+    __HAL_RCC_SYSCFG_CLK_ENABLE();
+
+    GPIO_InitTypeDef init = {};
+    init.Pin = 1u << line;
+    init.Mode = GPIO_MODE_IT_RISING_FALLING;
+    init.Pull = GPIO_NOPULL;
+    init.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+    HAL_GPIO_Init(ports[echoPinId.port], &init);
+
+    // highest priority, the handler is only a few instructions and any delay before the timestamp is measured distance
+    HAL_NVIC_SetPriority(irqOfLine(line), 0, 0);
+    HAL_NVIC_EnableIRQ(irqOfLine(line));
+    return true;
+}
+
+bool Ultrasonic::startMeasurement(const uint32_t timeout) {
+    if(capture.isBusy()) return false;
+
+    trigPin.Write(false); // write low voltage
+    daisy::System::DelayUs(2);
+    trigPin.Write(true); // write high voltage
+    daisy::System::DelayUs(5);
+    trigPin.Write(false); // write low voltage
+
+    previousTriggerTime = triggerTime;
+    triggerTime = daisy::System::GetUs();
+    return capture.start(triggerTime, timeout);
+}
+
+bool Ultrasonic::update(const float alpha) {
+    capture.poll(daisy::System::GetUs());
+
+    if(!capture.takeResult(lastPulse, lastListenTime)) return false;
+
+    const auto curDistance = static_cast<float>(lastPulse) * .343f; // in mm
+    if(filter) {
+        const float dt = static_cast<float>(triggerTime - previousTriggerTime) * 1e-6f;
+        distance = filter->process(curDistance, dt);
+    }
+    else {
+        distance = curDistance + alpha * (distance - curDistance);
+    }
+    return true;
+}
+
+bool UltrasonicPair::enableAsync() {
+    const bool isFirstOk = sensors[0]->enableAsync();
+    const bool isSecondOk = sensors[1]->enableAsync();
+    return isFirstOk && isSecondOk;
+}
+
+int UltrasonicPair::update(const float alpha) {
+    int finished = -1;
+    if(measuredSensor >= 0 && sensors[measuredSensor]->update(alpha)) {
+        finished = measuredSensor;
+        measuredSensor = -1;
+        scheduler.onResult(finished, sensors[finished]->getLastPulse(), sensors[finished]->getLastListenTime(), daisy::System::GetUs());
+    }
+
+    uint32_t timeout;
+    const int sensor = scheduler.next(daisy::System::GetUs(), timeout);
+    if(sensor >= 0 && sensors[sensor]->startMeasurement(timeout)) {
+        measuredSensor = sensor;
+        scheduler.onPing(sensor, daisy::System::GetUs());
+    }
+
+    return finished;
 }
\ No newline at end of file
@@ -3,10 +3,20 @@
 
 #include "daisy_seed.h"
 #include "daisysp.h"
+#include "EchoCapture.h"
+#include "PingScheduler.h"
+#include "DistanceFilter.h"
+
+/// EXTI lines of the echo pins as a mask of pin numbers, the PitchBox echoes are D23 (PA4) and D27 (PG9).
+/// Ultrasonic.cpp defines the interrupt vectors of these lines only and leaves the other lines of a shared vector
+/// alone, so the remaining vectors stay free for libDaisy and other EXTI users. Override with -D for other pins.
+#ifndef ULTRASONIC_ECHO_LINES
+#define ULTRASONIC_ECHO_LINES ((1u << 4) | (1u << 9))
+#endif
 
 class Ultrasonic {
   public:
-    Ultrasonic(daisy::Pin trigger, daisy::Pin echo)
+    Ultrasonic(daisy::Pin trigger, daisy::Pin echo) : echoPinId(echo)
     {
       echoPin.Init(echo, daisy::GPIO::Mode::INPUT, daisy::GPIO::Pull::NOPULL, daisy::GPIO::Speed::VERY_HIGH); // set it like an input
       trigPin.Init(trigger, daisy::GPIO::Mode::OUTPUT, daisy::GPIO::Pull::NOPULL, daisy::GPIO::Speed::VERY_HIGH); // set it like an output
@@ -23,6 +33,44 @@ class Ultrasonic {
     /// @return The distance in mm. If the returned value is negative it means the timeout was reached.
     float getDistanceFiltered(const float alpha = .5f, const uint32_t timeout = 10000);
 
+    /// @brief Switches the echo pin to an interrupt on both edges, which is needed by the asynchronous
+    /// measurements below. Every sensor needs its echo on a different EXTI line, i.e. a different pin number.
+    /// @return false if the echo line isn't in ULTRASONIC_ECHO_LINES, the interrupt isn't enabled then
+    bool enableAsync();
+
+    /// @brief Sends the trigger pulse and returns right away, the echo is captured by the pin interrupt.
+    /// Only the trigger pulse itself (a few microseconds) is waited for.
+    /// @param timeout Timeout time in microseconds
+    /// @return false if the previous measurement is still running
+    bool startMeasurement(const uint32_t timeout = 10000);
+
+    /// @brief Checks the running measurement, call it regularly from the main loop. When a measurement has finished
+    /// its distance is filtered by the filter set with setFilter, or with the same lowpass as getDistanceFiltered.
+    /// @param alpha Lowpass filter coef, only used without a filter
+    /// @return true if a new distance is available from getLastDistance()
+    bool update(const float alpha = .5f);
+
+    /// @brief True while a measurement started by startMeasurement hasn't finished yet
+    bool isMeasuring() const { return capture.isBusy(); }
+
+    /// @brief Sets the filter of the asynchronous measurements, nullptr for the lowpass. The filter isn't owned.
+    void setFilter(DistanceFilter* newFilter) { filter = newFilter; }
+
+    /// @brief The last filtered distance in mm, negative if the timeout was reached or the filter lost the hand
+    float getLastDistance() const { return distance; }
+
+    /// @brief Hand velocity in mm/s estimated by the filter, 0 if it doesn't track it
+    float getLastVelocity() const { return filter ? filter->getVelocity() : 0.f; }
+
+    /// @brief Length of the last echo pulse in microseconds, EchoCapture::TIMEOUT if the timeout was reached
+    int32_t getLastPulse() const { return lastPulse; }
+
+    /// @brief Time from the last trigger to the end of its echo (or the timeout) in microseconds
+    uint32_t getLastListenTime() const { return lastListenTime; }
+
+    /// @brief Forwards an edge of the echo pin to the capture, called from the EXTI interrupt
+    void onEchoEdge(const uint32_t time) { capture.onEdge(echoPin.Read(), time); }
+
   private:
     /// @brief Measures the time which the transmiter's ping took to reach the receiver.
     /// @param state The state which should be read as a ping (0 or 1)
@@ -32,8 +80,44 @@ class Ultrasonic {
 
     daisy::GPIO trigPin; // generic gpio object
     daisy::GPIO echoPin; // generic gpio object
+    daisy::Pin echoPinId;
+
+    EchoCapture capture;
+    DistanceFilter* filter = nullptr;
+    uint32_t triggerTime = 0;
+    uint32_t previousTriggerTime = 0;
+    int32_t lastPulse = EchoCapture::TIMEOUT;
+    uint32_t lastListenTime = 0;
 
     float distance = 0.f;
 };
 
+/// @brief Two sensors measured in the background, as fast as they can go without hearing each other's pings.
+/// See PingScheduler for the timing.
+class UltrasonicPair {
+  public:
+    UltrasonicPair(Ultrasonic& first, Ultrasonic& second, const PingScheduler::Config& config = PingScheduler::Config())
+      : sensors{&first, &second}, scheduler(config) {}
+
+    /// @brief Enables the asynchronous measurements of both sensors
+    /// @return false if one of them has no interrupt vector, see Ultrasonic::enableAsync
+    bool enableAsync();
+
+    /// @brief Collects a finished measurement and sends the next ping when it's due. Call it as often as possible
+    /// from the main loop, it never waits for an echo.
+    /// @param alpha Lowpass filter coef, see Ultrasonic::update
+    /// @return Index of the sensor with a new distance, -1 if there is none
+    int update(const float alpha = .5f);
+
+    /// @brief Valid distances per second of given sensor
+    float getUpdateRate(const int sensor) const { return scheduler.getUpdateRate(sensor); }
+
+    const PingScheduler& getScheduler() const { return scheduler; }
+
+  private:
+    Ultrasonic* sensors[PingScheduler::NUM_SENSORS];
+    PingScheduler scheduler;
+    int measuredSensor = -1;
+};
+
 #endif
\ No newline at end of file
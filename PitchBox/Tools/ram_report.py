@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+"""RAM usage of the firmware per subsystem and memory, from the linker map.
+
+Usage: ram_report.py build/PitchBox.map [Source]
+
+Every input section the linker placed is attributed to the subsystem of the object it came from: the directory
+under Source/ of the matching .cpp (Core, FM, Ultrasonic, ...), the library archive (libDaisy, DaisySP) or the
+toolchain's libraries. Sizes are summed per memory region of the STM32H750, flash is listed for completeness.
+"""
+
+import os
+import re
+import sys
+from collections import defaultdict
+
+# name, first address, size in bytes
+REGIONS = [
+    ("ITCM", 0x00000000, 64 * 1024),
+    ("FLASH", 0x08000000, 128 * 1024),
+    ("DTCM", 0x20000000, 128 * 1024),
+    ("SRAM", 0x24000000, 512 * 1024),
+    ("SRAM_D2", 0x30000000, 288 * 1024),
+    ("SRAM_D3", 0x38000000, 64 * 1024),
+    ("SDRAM", 0xC0000000, 64 * 1024 * 1024),
+    ("QSPI", 0x90000000, 8 * 1024 * 1024),
+]
+
+# sections which take space in the target's memory, the rest (debug info, comments) doesn't
+ALLOCATED = re.compile(r"^\.(text|rodata|data|bss|.*_bss|.*_data|isr_vector|ARM|init_array|fini_array|preinit_array|"
+                       r"tbss|tdata|noinit)|^COMMON$")
+
+SECTION_LINE = re.compile(r"^ (\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+SECTION_NAME = re.compile(r"^ (\S+)$")
+SECTION_CONTINUED = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+
+
+def region_of(address):
+    for name, start, size in REGIONS:
+        if start <= address < start + size:
+            return name
+    return None
+
+
+def source_subsystems(source_dir):
+    """Object base name -> subsystem, from the .cpp files under Source/"""
+    subsystems = {}
+    for root, _, files in os.walk(source_dir):
+        for file in files:
+            if file.endswith(".cpp"):
+                relative = os.path.relpath(root, source_dir)
+                subsystems[os.path.splitext(file)[0]] = "App" if relative == "." else relative.split(os.sep)[0]
+    return subsystems
+
+
+def subsystem_of(origin, subsystems):
+    archive = re.match(r"^(.*\.a)\((.*)\)$", origin)
+    if archive:
+        library = os.path.basename(archive.group(1)).lower()
+        if "daisysp" in library:
+            return "DaisySP"
+        if "daisy" in library:
+            return "libDaisy"
+        return "toolchain"
+
+    name = os.path.splitext(os.path.basename(origin))[0]
+    if name in subsystems:
+        return subsystems[name]
+    if "libDaisy" in origin:
+        return "libDaisy"
+    return "other"
+
+
+def parse(map_path, subsystems):
+    usage = defaultdict(lambda: defaultdict(int))  # subsystem -> region -> bytes
+    in_memory_map = False
+    pending = None
+
+    with open(map_path) as file:
+        for line in file:
+            line = line.rstrip("\n")
+            if line.startswith("Linker script and memory map"):
+                in_memory_map = True
+                continue
+            if not in_memory_map:
+                continue
+
+            if pending:
+                continued = SECTION_CONTINUED.match(line)
+                name, pending = pending, None
+                if continued:
+                    add(usage, name, int(continued.group(1), 16), int(continued.group(2), 16), continued.group(3),
+                        subsystems)
+                    continue
+
+            match = SECTION_LINE.match(line)
+            if match:
+                add(usage, match.group(1), int(match.group(2), 16), int(match.group(3), 16), match.group(4),
+                    subsystems)
+                continue
+
+            # long section names put the address, size and object on the next line
+            match = SECTION_NAME.match(line)
+            if match:
+                pending = match.group(1)
+
+    return usage
+
+
+def add(usage, section, address, size, origin, subsystems):
+    if size == 0 or not ALLOCATED.match(section) or origin.startswith("load address"):
+        return
+    region = region_of(address)
+    if region:
+        usage[subsystem_of(origin.strip(), subsystems)][region] += size
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__.strip().splitlines()[2], file=sys.stderr)
+        return 1
+
+    map_path = sys.argv[1]
+    source_dir = sys.argv[2] if len(sys.argv) > 2 else os.path.join(os.path.dirname(__file__), "..", "Source")
+    usage = parse(map_path, source_subsystems(source_dir))
+
+    regions = [name for name, _, _ in REGIONS if any(name in usage[s] for s in usage)]
+    width = max([len(s) for s in usage] + [9])
+
+    print("%-*s" % (width, "subsystem") + "".join("%11s" % name for name in regions))
+    for subsystem in sorted(usage, key=lambda s: -sum(v for r, v in usage[s].items() if r != "FLASH")):
+        print("%-*s" % (width, subsystem) + "".join("%11d" % usage[subsystem].get(name, 0) for name in regions))
+
+    totals = ["%11d" % sum(usage[s].get(name, 0) for s in usage) for name in regions]
+    print("%-*s" % (width, "total") + "".join(totals))
+    capacity = {name: size for name, _, size in REGIONS}
+    print("%-*s" % (width, "of") + "".join("%11d" % capacity[name] for name in regions))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())